@@ -3,10 +3,49 @@
 #include <time.h>
 #include <limits.h>
 #include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <math.h>
 
-#define MAX_PROCESSES 100
 #define TIME_QUANTUM 4
-#define MAX_IO_OPERATIONS 5  // 최대 I/O 작업 횟수
+#define MAX_IO_OPERATIONS 5  // 최대 I/O 작업 횟수 (random generator)
+#define PRIORITY_LEVELS 10   // Nominal priority values 0 ~ PRIORITY_LEVELS-1 (generator, nice 0 in the middle)
+#define PRIORITY_MAX_BUCKETS 256    // Bucket queue levels; a workload's priority range gets up to this many
+#define MAX_CPUS 128         // Simulated CPUs (--cpus)
+#define MLFQ_MAX_LEVELS 16   // MLFQ queue levels (--mlfq-quanta)
+#define MLFQ_BOOST_PERIOD 100
+#define CFS_TARGET_LATENCY 24   // CFS scheduling period for few runnable processes (--cfs-latency)
+#define CFS_MIN_GRANULARITY 3   // Shortest CFS slice (--cfs-granularity)
+#define SHARE_WINDOW 1000       // Share accuracy window of lottery and stride runs (--share-window)
+#define SHARE_MAX_TICKETS (1 << 20)     // Tickets of one process (--shares)
+#define STRIDE_ONE (1 << 30)    // Stride of one ticket; a process's stride is STRIDE_ONE / tickets
+#define GANTT_ENTRIES_PER_LINE 8
+#define SIM_ENGINE_VERSION 2    // Raise when a change alters simulation results; invalidates --cache entries
+
+// Hot-path helpers are forced inline so each scheduling mode gets its own specialized copy
+#if defined(__GNUC__)
+#define SIM_INLINE static inline __attribute__((always_inline))
+#else
+#define SIM_INLINE static inline
+#endif
+
+// Instrumentation of the engine, chosen at compile time (-DSIM_INSTRUMENT=n):
+//   0: compiled out, 1: event and queue counters (default), 2: counters and per-phase timing
+#ifndef SIM_INSTRUMENT
+#define SIM_INSTRUMENT 1
+#endif
+#if SIM_INSTRUMENT
+#define INSTR_COUNT(counter) ((counter)++)
+#else
+#define INSTR_COUNT(counter) ((void)0)
+#endif
 
 // I/O Operation Structure
 typedef struct {
@@ -14,628 +53,7435 @@ typedef struct {
     int burst_time;      // I/O 작업 시간
 } IOOperation;
 
-// Process Structure
+// Set of CPUs (affinity masks and per-CPU state bitmaps)
+#define CPU_MASK_WORDS (MAX_CPUS / 64)
+typedef struct {
+    uint64_t bits[CPU_MASK_WORDS];
+} CpuMask;
+
+// Process Structure: the run state of one process, one cache line. Workload data the engine
+// reads on every event or queue comparison is copied in; the rest stays in the workload.
+// Times are 64-bit; waiting and response time are kept aside in ProcessTimes.
 typedef struct {
     int pid;
-    int arrival_time;
-    int cpu_burst_time_initial;
     int priority;
+    int cpu_burst_time;
+    int remaining_cpu_total;        // 남아있는 CPU 시간
 
-    // Multiple I/O operations
-    IOOperation io_operations[MAX_IO_OPERATIONS];
-    int num_io_operations;
-    int current_io_index;  // 현재 진행 중인 I/O index
-
-    // Dynamic fields for simulation
-    int remaining_cpu_total;        // 남아있는 CPU 시간간
-    int cpu_done_current_segment;   // process가 실행되고 있을 때 실행한 시간
-    int total_cpu_done;             // 전체 CPU 실행 시간
-
-    int start_time;
-    int completion_time;
-    int waiting_time;
-    int turnaround_time;
-    int response_time;
-    int last_active_time;
-
-    // State: 0: not_arrived, 1: ready, 2: running, 3: waiting_io, 4: completed
-    int state;
-    int io_complete_at_time;
-    int has_started_execution;      // CPU에 할당 받았었는지 여부 확인
-    int current_quantum_slice;
-    
-    // For heap ordering in different contexts
-    int queue_entry_time; // When this process entered the current queue
+    // I/O operations still to come: io_left entries of the workload's I/O table from io_next.
+    // With generated phases io_next is the CPU time done at the next request, io_left 1 if one comes.
+    int io_next;
+    int io_left;
+
+    int heap_index;                 // Position in the heap holding this process, -1 if none
+    int8_t cpu;                     // CPU running the process or the last one that did, -1 before its first dispatch
+    int8_t mlfq_level;              // MLFQ queue level, 0 runs first
+
+    // Pending event of this process (a process never has more than one)
+    int8_t event_type;
+    int8_t event_level;   // Timing wheel level, the slot follows from event_time; WHEEL_DUE in the due heap
+    int64_t event_time;
+
+    int64_t arrival_time;
+    int64_t last_active_time;       // Last ready queue entry or CPU stop; completion time once completed
+    union {
+        struct {
+            int event_next;       // Other events in the same wheel slot (process indices, -1: none)
+            int event_prev;
+        };
+        int64_t stride_pass;      // Stride ready queue key; only while queued, when no event is pending
+    };
 } Process;
 
-Process processes[MAX_PROCESSES];
-Process original_processes[MAX_PROCESSES];
-int num_processes;
+_Static_assert(sizeof(Process) <= 64, "Process should fit in a cache line");
+_Static_assert(MAX_CPUS - 1 <= INT8_MAX, "Process.cpu holds any CPU number");
+
+// Time accounting of a process, indexed like the run's processes. Only dispatches and the
+// completion touch it.
+typedef struct {
+    int64_t waiting_time;
+    int64_t response_time;          // -1 until the first dispatch
+} ProcessTimes;
+
+// Size-class arena
+// Memory is taken from the system in large blocks and handed out in size classes
+// (four classes per power of two). Freed chunks go back to their class free list and
+// the whole arena is released in one shot.
+#define ARENA_MIN_ALLOC 64
+#define ARENA_NUM_CLASSES 232
+#define ARENA_DEFAULT_BLOCK (64 * 1024)
+
+typedef struct ArenaBlock {
+    struct ArenaBlock* next;
+    size_t size;        // usable bytes after the header
+    size_t used;
+} ArenaBlock;
+
+typedef struct {
+    ArenaBlock* blocks;                     // Current block first
+    void* free_lists[ARENA_NUM_CLASSES];    // Freed chunks per size class
+    size_t reserved;                        // Bytes obtained from the system
+    size_t peak_reserved;
+} Arena;
+
+// Heap operation counts (instrumentation)
+typedef struct {
+    uint64_t inserts;
+    uint64_t extracts;
+    uint64_t removes;
+    uint64_t compares;      // Comparator calls
+} HeapCounters;
 
 // Heap structures for different scheduling algorithms
 typedef struct {
-    Process* heap[MAX_PROCESSES];
+    Process** heap;     // Storage from an arena, grows on demand
     int size;
+    int capacity;
+    Arena* arena;
     int (*compare)(Process* a, Process* b); // Comparison function for heap ordering
+    HeapCounters counters;
 } ProcessHeap;
 
-// Queue structures - will be initialized in Config()
-ProcessHeap ready_queue;
-ProcessHeap waiting_queue;
+// Ring-buffer FIFO (Round Robin ready queue)
+typedef struct {
+    Process** slots;
+    int head;           // Oldest entry
+    int size;
+    int capacity;       // Power of two
+    Arena* arena;
+} ProcessFifo;
+
+// Hierarchical timing wheel holding every pending event (arrivals, I/O, CPU bursts).
+// Level k has WHEEL_SIZE slots of 2^(WHEEL_BITS*k) time units each. An event is linked into the
+// lowest level whose range around the wheel's time contains it and cascades one level down
+// when the wheel reaches its slot, so insert, cancel and expiry are O(1) amortized. Events of
+// the current instant wait in a small heap so they are handled in PID order. Slot lists link
+// process indices rather than pointers to keep Process within one cache line.
+#define WHEEL_BITS 8
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_LEVELS 8              // Covers every non-negative 64-bit time
+#define WHEEL_WORDS (WHEEL_SIZE / 64)
+#define WHEEL_DUE (-1)              // event_level of events in the due heap
+
+typedef struct {
+    int slots[WHEEL_LEVELS][WHEEL_SIZE];            // List heads, doubly linked through Process.event_next/prev
+    uint64_t occupied[WHEEL_LEVELS][WHEEL_WORDS];   // Non-empty slots
+    int64_t now;            // Time of the due events; all other events are later
+    int size;               // Pending events, due ones included
+    ProcessHeap due;        // Events at `now`, PID order
+    uint64_t cascades;      // Events moved down a level
+    Process* processes;     // Base of the list indices
+} TimingWheel;
+
+// Event types kept in the timing wheel
+enum EventType {
+    EVENT_NONE,
+    EVENT_ARRIVAL,          // Process enters the ready queue for the first time
+    EVENT_IO_COMPLETE,      // Process returns from I/O to the ready queue
+    EVENT_IO_REQUEST,       // Running process issues its next I/O request
+    EVENT_CPU_COMPLETE,     // Running process finishes its last CPU burst
+    EVENT_QUANTUM_EXPIRE    // Running process used up its RR time slice
+};
 
 // Gantt chart
 typedef struct {
     int pid;
-    int start;
-    int end;
+    int cpu;
+    int64_t start;
+    int64_t end;
+    int overhead;       // Switch, cache refill or migration time before pid makes progress
 } GanttEntry;
-GanttEntry gantt_chart[MAX_PROCESSES * 50];
-int gantt_idx = 0;
+
+// Trace events streamed to a TraceSink while a simulation runs
+enum TraceEventType {
+    TRACE_CPU_SLICE,        // Gantt slice [start, end) of pid (0 = idle)
+    TRACE_IO,               // pid is blocked on I/O during [start, end)
+    TRACE_READY,            // pid waited in the ready queue during [start, end)
+    TRACE_PREEMPT,          // pid lost the CPU at start; arg = preempting pid, 0 for quantum expiry
+    TRACE_OVERHEAD          // The CPU spent [start, end) switching to pid (dispatch, cache refill, migration)
+};
+
+typedef struct {
+    int type;
+    int pid;
+    int64_t start;
+    int64_t end;
+    int arg;
+    int cpu;                // CPU of slices, preemptions and ready-queue waits
+} TraceEvent;
+
+// Pluggable trace output; a sink owns its resources and releases them in finish()
+typedef struct TraceSink {
+    void (*emit)(struct TraceSink* sink, const TraceEvent* event);
+    int (*finish)(struct TraceSink* sink);     // Flush, close and free; returns 0 on success
+} TraceSink;
+
+enum TraceFormat {
+    TRACE_FORMAT_BINARY,    // Compact run-length encoded records
+    TRACE_FORMAT_CHROME     // Chrome Trace Event JSON (chrome://tracing, Perfetto)
+};
 
 // Current scheduling mode for ready queue comparison
 enum SchedulingMode {
     FCFS_MODE,
     SJF_MODE,
     PRIORITY_MODE,
-    RR_MODE
-} current_scheduling_mode;
+    RR_MODE,
+    MLFQ_MODE,
+    CFS_MODE,
+    EDF_MODE,       // Earliest deadline first
+    RM_MODE,        // Rate monotonic: shortest period first
+    LOTTERY_MODE,   // Proportional share: random draw weighted by tickets
+    STRIDE_MODE     // Proportional share: smallest pass first, pass advancing by 1/tickets
+};
+#define NUM_SCHEDULING_MODES (STRIDE_MODE + 1)
 
 // Preemption mode
 enum PreemptionMode {
     NON_PREEMPTIVE,
     PREEMPTIVE
-} current_preemption_mode;
+};
+
+// CFS state of one process. Ready processes of a CPU form a red-black tree ordered by vruntime;
+// links are indices into the run's entity array, whose last entry is the shared nil sentinel.
+typedef struct {
+    int64_t vruntime;       // CPU time weighted by 1024/weight, in units of 2^-CFS_VRUNTIME_SHIFT
+    int weight;             // From the priority, as a nice value
+    int left, right, parent;
+    int red;
+} CfsEntity;
+
+typedef struct {
+    CfsEntity* entities;    // Indexed like the run's processes
+    Process* processes;
+    int nil;                // Sentinel index
+    int root;
+    int leftmost;           // Cached minimum; nil when empty
+    int64_t min_vruntime;   // Never decreases; processes joining the queue start from it
+    int64_t load;           // Sum of the queued weights
+    uint64_t rotations;
+} CfsTree;
+
+// Pseudo-random generator: xoshiro256** with splitmix64 seeding (rng_seed)
+typedef struct {
+    uint64_t s[4];
+} Xoshiro256;
+
+// Proportional share state of a CPU's ready queue. Lottery: queued processes fill slots 1..size
+// (a process's slot is its heap_index) and a Fenwick tree over the slots sums their tickets, so
+// a draw finds its winner by prefix-sum search and a removal moves the last slot into the gap.
+// Stride: the queue's heap orders by Process.stride_pass, copied from the run's passes on entry.
+typedef struct {
+    const int* tickets;     // The run's tickets per process
+    int64_t* passes;        // The run's stride pass per process
+    Process* processes;
+    int64_t min_pass;       // Stride: never decreases; processes joining the queue start from it
+    int64_t* tree;          // Lottery: 1-based Fenwick tree of the slots' tickets
+    Process** slots;        // Lottery: 1-based
+    int capacity;           // Lottery: slots, a power of two
+    int winner;             // Lottery: slot drawn for the next dispatch, 0: none drawn yet
+    Arena* arena;
+    Xoshiro256 rng;         // Lottery draws
+} ShareQueue;
+
+// Ready queue specialized per scheduling mode
+//   FCFS, SJF : binary heap with the mode's comparator inlined
+//   RR        : ring-buffer FIFO
+//   Priority  : one queue per priority level, non-empty levels tracked in a bitmap
+//   MLFQ      : one FIFO per level, non-empty levels in a single bitmap word
+//   CFS       : red-black tree keyed by vruntime with the leftmost node cached
+//   EDF, RM   : binary heap keyed by absolute deadline or period
+//   Lottery   : Fenwick tree of tickets
+//   Stride    : binary heap keyed by pass
+typedef struct {
+    enum SchedulingMode mode;
+    int size;
+    ProcessHeap heap;
+    ProcessFifo fifo;
+    ProcessHeap* buckets;       // One per priority from bucket_base; priority, then arrival order inside
+    uint64_t* bucket_bitmap;    // Non-empty buckets
+    int bucket_base;
+    int num_buckets;
+    ProcessFifo levels[MLFQ_MAX_LEVELS];    // Queue order inside a level
+    uint64_t level_bitmap;
+    CfsTree cfs;
+    ShareQueue share;
+} ReadyQueue;
+
+// Fair-share clock of a CPU in share accuracy runs: it advances by dt / (tickets of the processes
+// runnable on the CPU), so a process runnable over [a, b) is entitled to tickets * (V(b) - V(a))
+// of CPU time. Its values at window ends are kept for processes that catch up later.
+typedef struct {
+    double vtime;
+    int64_t tickets;        // Of the processes queued on or running on the CPU
+    int64_t since;          // Time vtime is at
+    int64_t windows;        // Window ends passed; boundary[k] is vtime at the end of window k
+    double* boundary;
+    int64_t capacity;
+} ShareClock;
+
+// One simulated CPU: its own ready queue, the process it runs and its share of the run's totals
+typedef struct {
+    int id;
+    ReadyQueue ready_queue;
+    Process* running;
+    Process* last_dispatched;   // For context switch counting
+    int64_t dispatch_time;      // When `running` got the CPU
+    int64_t run_start;          // When `running` makes progress; later than dispatch_time by the overhead
+    int preempted;              // The last process to stop here was preempted or used up its slice
+    int64_t idle_since;
+    GanttEntry gantt_pending;   // Open slice, extended while the same process keeps running
+    int has_gantt_pending;
+
+    int64_t busy_time;          // CPU time spent running processes (overhead excluded)
+    int64_t overhead_time;      // Dispatch, preemption, cache refill and migration costs
+    uint64_t dispatches;
+    uint64_t migrations;        // Dispatches of a process that last ran on another CPU
+    uint64_t steals;            // Processes taken from another CPU's ready queue
+    ShareClock share_clock;     // Share accuracy runs only
+} Cpu;
+
+// Simulated machine. The costs delay the progress of a dispatched process and are spent on the CPU's
+// timeline: dispatch_cost on every context switch, preemption_cost on a switch after a preemption
+// or quantum expiry, and refill_cost after refill_time off the CPU (in proportion for shorter absences).
+typedef struct {
+    int num_cpus;
+    int migration_cost;         // Time a process spends on a CPU other than its last one before it makes progress
+    int dispatch_cost;
+    int preemption_cost;
+    int refill_cost;            // 0: no cache model
+    int refill_time;            // Off-CPU time after which the cache is cold
+} MachineConfig;
+
+// Multi-level feedback queue: a process that uses up its level's quantum moves down a level,
+// one returning from I/O moves up a level, and every boost_period all go back to level 0
+typedef struct {
+    int num_levels;
+    int quanta[MLFQ_MAX_LEVELS];    // Time slice per level
+    int boost_period;               // 0: no boost
+} MlfqConfig;
+
+// Completely fair scheduler: runnable processes share a period of target_latency (or
+// min_granularity per process when more are runnable) in proportion to their weights
+typedef struct {
+    int target_latency;
+    int min_granularity;
+} CfsConfig;
+
+// Lottery and stride: processes hold tickets (from --shares, else the CFS weight of their priority)
+// and get CPU in proportion to them, a time quantum at a time. Lottery draws from `seed`; share
+// accuracy is measured over windows of `window` time units.
+typedef struct {
+    uint64_t seed;
+    int window;
+} ShareConfig;
+
+// Tunables of the scheduling policies
+typedef struct {
+    int time_quantum;           // Round Robin, lottery and stride time slice
+    MlfqConfig mlfq;
+    CfsConfig cfs;
+    ShareConfig share;
+} PolicyConfig;
+
+// Workload record: the static description of one process. This is also the on-disk
+// layout of the binary workload format, so a mapped file is used in place.
+typedef struct {
+    int32_t pid;
+    int32_t arrival_time;
+    int32_t cpu_burst_time;
+    int32_t priority;
+    uint32_t io_first;      // First entry in the workload's I/O table
+    uint32_t io_count;
+} WorkloadRecord;
+
+// Real-time parameters of a workload record, all zero for a process without any. Jobs of a
+// periodic task are records with the task's pid and period.
+typedef struct {
+    int32_t deadline;       // Relative to the arrival, 0: none
+    int32_t period;         // Release period of the record's task, 0: aperiodic
+    int32_t jitter;         // How late the arrival is after the nominal release of the job
+} RealtimeRecord;
+
+// CPU/I/O phases generated on demand instead of the I/O table (defined with the generator)
+typedef struct PhaseModel PhaseModel;
+
+// Open-system run state (--stream)
+typedef struct StreamState StreamState;
+
+// Workload: the processes to schedule. Read-only while simulations run, so it can be
+// shared by any number of simulation contexts.
+typedef struct {
+    const WorkloadRecord* records;
+    const IOOperation* io_operations;   // I/O table shared by all records
+    int count;
+    size_t num_io_operations;
+    Arena arena;            // Storage of generated or imported workloads
+    void* mapping;          // Storage of workloads mapped from a binary file
+    size_t mapping_size;
+    CpuMask* affinity;      // Per record, NULL: every process may run on any CPU (not part of the file format)
+    int* arrival_order;     // Record indices in arrival order, NULL if the records already are
+    const PhaseModel* phases;   // Replaces the I/O table, NULL: none (not part of the file format)
+    const RealtimeRecord* realtime;     // Per record, NULL: no deadlines or periods
+    int* shares;            // Lottery and stride tickets per record, NULL: from the priorities (not part of the file format)
+} Workload;
+
+// Binary workload file: header, WorkloadRecord[num_processes], IOOperation[num_io_operations]
+// and, if the workload has deadlines, RealtimeRecord[num_processes]. Version 1 files have no
+// real-time table and end their header before realtime_offset.
+#define WORKLOAD_MAGIC "CPUSWKLD"
+#define WORKLOAD_VERSION 2
+#define WORKLOAD_BYTE_ORDER 0x01020304u
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;        // Written natively; rejects files from other endianness
+    uint64_t num_processes;
+    uint64_t num_io_operations;
+    uint64_t records_offset;    // From the start of the file
+    uint64_t io_offset;
+    uint64_t realtime_offset;   // 0: no real-time table
+} WorkloadFileHeader;
+
+#define WORKLOAD_HEADER_V1_SIZE (sizeof(WorkloadFileHeader) - sizeof(uint64_t))
+
+_Static_assert(sizeof(IOOperation) == 8, "IOOperation is part of the binary workload format");
+_Static_assert(sizeof(WorkloadRecord) == 24, "WorkloadRecord is part of the binary workload format");
+_Static_assert(sizeof(RealtimeRecord) == 12, "RealtimeRecord is part of the binary workload format");
+
+// Streaming statistics: exact sum for the mean, Welford's M2 for the variance.
+// Partial results merge with Chan's parallel formula.
+typedef struct {
+    uint64_t count;
+    int64_t sum;
+    double mean;
+    double m2;                  // Sum of squared deviations from the mean
+    int64_t max;
+} RunningStats;
+
+// Log-linear histogram of non-negative 64-bit times. Values below 2^HISTOGRAM_SUB_BITS have their
+// own bucket; larger values share buckets whose width is at most 1/2^(HISTOGRAM_SUB_BITS-1) of the
+// value (1.6%). Histograms merge by adding counts.
+#define HISTOGRAM_SUB_BITS 7
+#define HISTOGRAM_BUCKETS ((63 - HISTOGRAM_SUB_BITS + 2) << (HISTOGRAM_SUB_BITS - 1))
+
+typedef struct {
+    RunningStats stats;
+    uint64_t buckets[HISTOGRAM_BUCKETS];
+} LatencyDistribution;
+
+// Phases of the event loop timed with SIM_INSTRUMENT >= 2
+enum SimPhase {
+    PHASE_ARRIVALS,         // Arrival events
+    PHASE_IO,               // I/O requests and completions
+    PHASE_PREEMPTION,       // Preemption check and quantum expiries
+    PHASE_DISPATCH,         // Picking the next process
+    PHASE_ADVANCE,          // Time advance: idle fast-forward, next event, burst completions
+    NUM_SIM_PHASES
+};
+
+const char* const sim_phase_names[NUM_SIM_PHASES] = {"arrivals", "io", "preemption", "dispatch", "advance"};
+
+// Engine counters (all zero when SIM_INSTRUMENT is 0)
+typedef struct {
+    HeapCounters heap;          // Event queue and ready queue heaps together
+    uint64_t preemptions;       // Running process displaced by a better one
+    uint64_t quantum_expiries;
+    uint64_t mlfq_boosts;
+    uint64_t io_requests;
+    uint64_t io_completions;
+    uint64_t idle_fast_forwards;    // Idle stretches skipped in one step
+    uint64_t gantt_coalesces;       // Slices merged into the open Gantt slice
+    uint64_t wheel_cascades;        // Timing wheel events moved down a level
+    uint64_t cfs_rotations;         // CFS red-black tree rotations
+    uint64_t phase_ns[NUM_SIM_PHASES];
+} InstrCounters;
+
+// Results of one run (or the merge of several runs), accumulated as processes complete
+typedef struct {
+    int runs;
+    int num_processes;
+    int completed_count;
+    LatencyDistribution waiting;
+    LatencyDistribution turnaround;
+    LatencyDistribution response;
+    double total_makespan;      // Sum over runs of the last completion time
+    double total_busy_time;     // CPU time spent running processes
+    uint64_t context_switches;  // Dispatches of a different process than the one that ran last
+    uint64_t preemptions;       // Context switches after a preemption or quantum expiry
+    uint64_t cache_refills;     // Dispatches that paid a cache refill
+    double total_overhead_time; // CPU time spent on switches, cache refills and migrations
+    uint64_t deadline_processes; // Completed processes that had a deadline
+    uint64_t deadline_misses;    // Those completed after it
+    LatencyDistribution lateness;   // Their completion minus deadline, 0 when on time
+    uint64_t share_windows;     // Windows in which a process was runnable (lottery and stride)
+    double share_entitled;      // CPU time its tickets entitled it to in them
+    double share_error;         // Sum of |received - entitled| over them
+    LatencyDistribution share_deviation;    // |received - entitled| per window, rounded
+    int num_cpus;
+    uint64_t migrations;
+    uint64_t steals;
+    double total_imbalance;     // Sum over runs of the load imbalance (max / mean CPU busy time - 1)
+    uint64_t events;            // Events handled by the engine
+    uint64_t dispatches;
+    InstrCounters instr;
+    size_t peak_memory;         // Largest workload + simulation memory footprint
+} SimMetrics;
+
+// Share accuracy state of a process: CPU time received and entitled in its current window
+typedef struct {
+    double entitled;
+    double vmark;           // Fair-share clock of its CPU at `last`
+    int64_t received;
+    int64_t last;           // Time accounted up to
+    int64_t window;
+    int cpu;                // CPU whose clock it follows, -1 while not runnable
+} ShareState;
+
+// Simulation context: all state of one simulation, so several can run at once
+typedef struct {
+    const Workload* workload;
+    int num_processes;
+    Arena arena;                // Per-run storage: processes, queues and Gantt chart
+
+    Process* processes;         // Run state of the workload's processes, in arrival order
+    const IOOperation* io_operations;   // The workload's I/O table
+    const PhaseModel* phases;           // The workload's generated phases, NULL: use the I/O table
+    const RealtimeRecord* realtime;     // The workload's deadlines and periods, NULL: none
+    StreamState* stream;                // Open-system run: processes come from a source, NULL: the workload
+    TimingWheel event_wheel;    // Pending events (arrivals, I/O, CPU bursts)
+
+    MachineConfig machine;
+    Cpu* cpus;                  // machine.num_cpus entries
+    CpuMask dirty;              // CPUs whose queue or running process changed at the current instant
+    CpuMask available;          // Idle CPUs with an empty ready queue
+    CpuMask queued;             // CPUs with a non-empty ready queue
+    int next_cpu;               // Round-robin placement of processes no idle CPU takes
+    int priorities[2];          // Lowest and highest workload priority, the priority queue's bucket range
+
+    GanttEntry* gantt_chart;    // Closed slices of all CPUs, kept only for the verbose report
+    int gantt_idx;
+    int gantt_capacity;
+    TraceSink* trace;           // Optional streaming output of slices and scheduling events
+
+    enum SchedulingMode scheduling_mode;
+    enum PreemptionMode preemption_mode;
+    PolicyConfig policy;
+    CfsEntity* cfs_entities;    // CFS runs only: one per process plus the tree sentinel
+    ProcessTimes* times;        // Waiting and response time per process
+    int64_t* off_cpu_since;     // Cache refill model only: when each process last left a CPU
+    int* tickets;               // Lottery and stride runs only: tickets per process
+    int64_t* stride_passes;     // Lottery and stride runs only: pass per process
+    ShareState* shares;         // Share accuracy runs only, per process
+    int verbose;                // Print the run header and Evaluation report
+    SimMetrics metrics;         // Accumulated while the run progresses
+
+    // Event loop position, kept between sim_run_until calls
+    int64_t current_time;
+    int completed_count;
+    int running_count;          // CPUs running a process
+    int next_arrival_idx;       // processes[] is sorted by arrival; only the next arrival is queued
+    int64_t next_boost;         // Next MLFQ boost, INT64_MAX if none
+    int64_t checkpoint_time;    // Time a stopped run stopped at, -1 once it has finished
+    uint64_t phase_mark_ns;     // Start of the phase being timed (SIM_INSTRUMENT >= 2)
+} SimContext;
+
+// Workload record of a process of the run
+SIM_INLINE int process_record(const SimContext* ctx, const Process* p) {
+    int index = (int)(p - ctx->processes);
+    return ctx->workload->arrival_order != NULL ? ctx->workload->arrival_order[index] : index;
+}
+
+// CPUs the process may run on, NULL: any
+SIM_INLINE const CpuMask* process_affinity(const SimContext* ctx, const Process* p) {
+    const CpuMask* affinity = ctx->workload->affinity;
+    return affinity != NULL ? &affinity[process_record(ctx, p)] : NULL;
+}
+
+// EDF and rate-monotonic runs keep their ready queue key in Process.priority (see realtime_key)
+SIM_INLINE int realtime_mode(enum SchedulingMode mode) {
+    return mode == EDF_MODE || mode == RM_MODE;
+}
+
+// Lottery and stride runs hold tickets (see share_reset)
+SIM_INLINE int share_mode(enum SchedulingMode mode) {
+    return mode == LOTTERY_MODE || mode == STRIDE_MODE;
+}
+
+// Scheduler variants offered by the menu, in menu order; the real-time and proportional share
+// ones are batch only
+typedef struct {
+    const char* name;           // Name passed to run_scheduler_generic
+    const char* label;          // Name including the preemption mode
+    const char* key;            // Short name used in file names
+    enum SchedulingMode mode;
+    enum PreemptionMode preemption_mode;
+} SchedulerVariant;
+
+const SchedulerVariant scheduler_variants[] = {
+    {"FCFS", "FCFS", "fcfs", FCFS_MODE, NON_PREEMPTIVE},
+    {"SJF", "SJF (Non-Preemptive)", "sjf", SJF_MODE, NON_PREEMPTIVE},
+    {"SJF", "SJF (Preemptive)", "sjf-p", SJF_MODE, PREEMPTIVE},
+    {"Priority", "Priority (Non-Preemptive)", "priority", PRIORITY_MODE, NON_PREEMPTIVE},
+    {"Priority", "Priority (Preemptive)", "priority-p", PRIORITY_MODE, PREEMPTIVE},
+    {"Round Robin", "Round Robin", "rr", RR_MODE, NON_PREEMPTIVE},
+    {"MLFQ", "MLFQ", "mlfq", MLFQ_MODE, PREEMPTIVE},
+    {"CFS", "CFS", "cfs", CFS_MODE, PREEMPTIVE},
+    {"EDF", "EDF", "edf", EDF_MODE, PREEMPTIVE},
+    {"Rate Monotonic", "Rate Monotonic", "rm", RM_MODE, PREEMPTIVE},
+    {"Lottery", "Lottery", "lottery", LOTTERY_MODE, NON_PREEMPTIVE},
+    {"Stride", "Stride", "stride", STRIDE_MODE, NON_PREEMPTIVE},
+};
+#define NUM_SCHEDULER_VARIANTS ((int)(sizeof(scheduler_variants) / sizeof(scheduler_variants[0])))
+
+// Comparison functions for different scheduling algorithms. Keys are compared through their
+// 64-bit difference: imported values can be far enough apart to overflow an int subtraction.
+static inline int compare_fcfs(Process* a, Process* b) {
+    int64_t d = (int64_t)a->arrival_time - b->arrival_time;  // Earlier arrival has higher priority
+    if (d == 0) d = (int64_t)a->pid - b->pid;                // Tie-break by PID
+    return (d > 0) - (d < 0);
+}
+
+static inline int compare_sjf(Process* a, Process* b) {
+    int64_t d = (int64_t)a->remaining_cpu_total - b->remaining_cpu_total;  // Shorter job has higher priority
+    if (d == 0) d = (int64_t)a->arrival_time - b->arrival_time;            // Earlier arrival breaks tie
+    if (d == 0) d = (int64_t)a->pid - b->pid;
+    return (d > 0) - (d < 0);
+}
+
+// Priority buckets: lower priority value first. A bucket holds one priority unless priorities
+// outside the bucket range share an end bucket.
+static inline int compare_priority(Process* a, Process* b) {
+    int64_t d = (int64_t)a->priority - b->priority;
+    if (d == 0) d = (int64_t)a->arrival_time - b->arrival_time;
+    if (d == 0) d = (int64_t)a->pid - b->pid;
+    return (d > 0) - (d < 0);
+}
+
+// EDF and rate-monotonic order: smaller key (absolute deadline or period) first
+static inline int compare_realtime(Process* a, Process* b) {
+    int64_t d = (int64_t)a->priority - b->priority;
+    if (d == 0) d = (int64_t)a->arrival_time - b->arrival_time;
+    if (d == 0) d = (int64_t)a->pid - b->pid;
+    return (d > 0) - (d < 0);
+}
+
+// Stride order: smallest pass first
+static inline int compare_stride(Process* a, Process* b) {
+    if (a->stride_pass != b->stride_pass) return a->stride_pass < b->stride_pass ? -1 : 1;
+    return (a->pid > b->pid) - (a->pid < b->pid);
+}
+
+static inline int compare_event(Process* a, Process* b) {
+    int64_t d = (int64_t)a->event_time - b->event_time;  // Earlier event first
+    if (d == 0) d = (int64_t)a->pid - b->pid;            // Same instant: PID order, like the ready queue tie-breaks
+    return (d > 0) - (d < 0);
+}
+
+// Arena utility functions
+void arena_out_of_memory(size_t size) {
+    fprintf(stderr, "Out of memory: could not allocate %zu bytes\n", size);
+    exit(EXIT_FAILURE);
+}
+
+// Round a request up to its size class; returns the class index
+int arena_size_class(size_t size, size_t* class_size) {
+    if (size <= ARENA_MIN_ALLOC) {
+        *class_size = ARENA_MIN_ALLOC;
+        return 0;
+    }
+
+    size_t pow2 = ARENA_MIN_ALLOC;
+    int shift = 6;
+    while (pow2 < size) {
+        pow2 <<= 1;
+        shift++;
+    }
+
+    // size is in (pow2/2, pow2]: split that range into four classes
+    size_t step = pow2 / 8;
+    size_t rounded = (size + step - 1) / step * step;
+    *class_size = rounded;
+    return (shift - 7) * 4 + (int)(rounded / step - 5) + 1;
+}
+
+size_t arena_class_size(size_t size) {
+    size_t class_size;
+    arena_size_class(size, &class_size);
+    return class_size;
+}
+
+void arena_add_block(Arena* arena, size_t min_size) {
+    size_t size = min_size > ARENA_DEFAULT_BLOCK ? min_size : ARENA_DEFAULT_BLOCK;
+    ArenaBlock* block = malloc(sizeof(ArenaBlock) + size);
+    if (block == NULL) arena_out_of_memory(size);
+
+    block->next = arena->blocks;
+    block->size = size;
+    block->used = 0;
+    arena->blocks = block;
+    arena->reserved += sizeof(ArenaBlock) + size;
+    if (arena->reserved > arena->peak_reserved) {
+        arena->peak_reserved = arena->reserved;
+    }
+}
+
+// Size the arena once for the expected total so a run normally needs a single block
+void arena_init(Arena* arena, size_t expected_size) {
+    memset(arena->free_lists, 0, sizeof(arena->free_lists));
+    arena->blocks = NULL;
+    arena->reserved = 0;
+    arena->peak_reserved = 0;
+    arena_add_block(arena, expected_size);
+}
+
+void* arena_alloc(Arena* arena, size_t size) {
+    size_t class_size;
+    int cls = arena_size_class(size, &class_size);
+
+    if (arena->free_lists[cls] != NULL) {
+        void* chunk = arena->free_lists[cls];
+        arena->free_lists[cls] = *(void**)chunk;
+        return chunk;
+    }
+
+    if (arena->blocks == NULL || arena->blocks->size - arena->blocks->used < class_size) {
+        arena_add_block(arena, class_size);
+    }
+    void* chunk = (char*)(arena->blocks + 1) + arena->blocks->used;
+    arena->blocks->used += class_size;
+    return chunk;
+}
+
+void arena_free(Arena* arena, void* chunk, size_t size) {
+    if (chunk == NULL) return;
+    size_t class_size;
+    int cls = arena_size_class(size, &class_size);
+    *(void**)chunk = arena->free_lists[cls];
+    arena->free_lists[cls] = chunk;
+}
+
+// Move an allocation to a larger size class, keeping its contents
+void* arena_grow(Arena* arena, void* chunk, size_t old_size, size_t new_size) {
+    void* grown = arena_alloc(arena, new_size);
+    if (chunk != NULL) {
+        memcpy(grown, chunk, old_size);
+        arena_free(arena, chunk, old_size);
+    }
+    return grown;
+}
+
+// Release every block at once
+void arena_release(Arena* arena) {
+    ArenaBlock* block = arena->blocks;
+    while (block != NULL) {
+        ArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    memset(arena->free_lists, 0, sizeof(arena->free_lists));
+    arena->blocks = NULL;
+    arena->reserved = 0;
+}
+
+// Heap utility functions
+void heap_init(ProcessHeap* heap, int (*compare_func)(Process* a, Process* b)) {
+    heap->heap = NULL;
+    heap->size = 0;
+    heap->capacity = 0;
+    heap->arena = NULL;
+    heap->compare = compare_func;
+    memset(&heap->counters, 0, sizeof(heap->counters));
+}
+
+// (Re)attach heap storage for at least `capacity` entries; the heap is emptied
+void heap_reserve(ProcessHeap* heap, Arena* arena, int capacity) {
+    if (capacity < 16) capacity = 16;
+    heap->heap = arena_alloc(arena, (size_t)capacity * sizeof(Process*));
+    heap->size = 0;
+    heap->capacity = capacity;
+    heap->arena = arena;
+}
+
+// Place a process at `index` and record the position in the process (indexed heap)
+SIM_INLINE void heap_place(ProcessHeap* heap, int index, Process* process) {
+    heap->heap[index] = process;
+    process->heap_index = index;
+}
+
+// The *_with variants take the comparator as a parameter; hot paths pass a constant
+// comparator so it is inlined instead of called through heap->compare.
+
+// Sift up by moving parents down into the hole; returns the final index
+SIM_INLINE int heap_heapify_up_with(ProcessHeap* heap, int index, int (*compare)(Process* a, Process* b)) {
+    Process* process = heap->heap[index];
+
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        INSTR_COUNT(heap->counters.compares);
+        if (compare(process, heap->heap[parent]) >= 0) break;
+        heap_place(heap, index, heap->heap[parent]);
+        index = parent;
+    }
+    heap_place(heap, index, process);
+    return index;
+}
+
+SIM_INLINE int heap_heapify_down_with(ProcessHeap* heap, int index, int (*compare)(Process* a, Process* b)) {
+    Process* process = heap->heap[index];
+
+    while (1) {
+        int left = 2 * index + 1;
+        if (left >= heap->size) break;
+
+        int smallest = left;
+        int right = left + 1;
+        if (right < heap->size) {
+            INSTR_COUNT(heap->counters.compares);
+            if (compare(heap->heap[right], heap->heap[left]) < 0) smallest = right;
+        }
+        INSTR_COUNT(heap->counters.compares);
+        if (compare(heap->heap[smallest], process) >= 0) break;
+
+        heap_place(heap, index, heap->heap[smallest]);
+        index = smallest;
+    }
+    heap_place(heap, index, process);
+    return index;
+}
+
+void heap_grow(ProcessHeap* heap) {
+    heap->heap = arena_grow(heap->arena, heap->heap, (size_t)heap->capacity * sizeof(Process*),
+                            (size_t)heap->capacity * 2 * sizeof(Process*));
+    heap->capacity *= 2;
+}
+
+SIM_INLINE void heap_insert_with(ProcessHeap* heap, Process* process, int (*compare)(Process* a, Process* b)) {
+    if (heap->size >= heap->capacity) heap_grow(heap);
+    INSTR_COUNT(heap->counters.inserts);
+    
+    heap->heap[heap->size] = process;
+    heap->size++;
+    heap_heapify_up_with(heap, heap->size - 1, compare);
+}
+
+SIM_INLINE Process* heap_extract_min_with(ProcessHeap* heap, int (*compare)(Process* a, Process* b)) {
+    if (heap->size == 0) return NULL;
+    
+    Process* min = heap->heap[0];
+    heap->size--;
+    INSTR_COUNT(heap->counters.extracts);
+    
+    if (heap->size > 0) {
+        heap->heap[0] = heap->heap[heap->size];
+        heap_heapify_down_with(heap, 0, compare);
+    }
+    
+    min->heap_index = -1;
+    return min;
+}
+
+// Restore heap order after the key of a queued process changed (decrease-key or increase-key)
+SIM_INLINE void heap_update_with(ProcessHeap* heap, Process* process, int (*compare)(Process* a, Process* b)) {
+    int index = process->heap_index;
+    if (heap_heapify_up_with(heap, index, compare) == index) {
+        heap_heapify_down_with(heap, index, compare);
+    }
+}
+
+// Remove specific process from heap (for preemption); O(log n) through its stored position
+SIM_INLINE int heap_remove_with(ProcessHeap* heap, Process* process, int (*compare)(Process* a, Process* b)) {
+    int index = process->heap_index;
+    if (index < 0 || index >= heap->size || heap->heap[index] != process) return 0; // Not in this heap
+
+    INSTR_COUNT(heap->counters.removes);
+    heap->size--;
+    if (index < heap->size) {
+        heap_place(heap, index, heap->heap[heap->size]);
+        heap_update_with(heap, heap->heap[index], compare);
+    }
+
+    process->heap_index = -1;
+    return 1; // Success
+}
+
+// Generic versions using the heap's own comparison function
+int heap_heapify_up(ProcessHeap* heap, int index) {
+    return heap_heapify_up_with(heap, index, heap->compare);
+}
+
+int heap_heapify_down(ProcessHeap* heap, int index) {
+    return heap_heapify_down_with(heap, index, heap->compare);
+}
+
+void heap_insert(ProcessHeap* heap, Process* process) {
+    heap_insert_with(heap, process, heap->compare);
+}
+
+Process* heap_extract_min(ProcessHeap* heap) {
+    return heap_extract_min_with(heap, heap->compare);
+}
+
+void heap_update(ProcessHeap* heap, Process* process) {
+    heap_update_with(heap, process, heap->compare);
+}
+
+int heap_remove(ProcessHeap* heap, Process* process) {
+    return heap_remove_with(heap, process, heap->compare);
+}
+
+// FIFO utility functions
+void fifo_reserve(ProcessFifo* fifo, Arena* arena, int capacity) {
+    int rounded = 16;
+    while (rounded < capacity) rounded <<= 1;
+    fifo->slots = arena_alloc(arena, (size_t)rounded * sizeof(Process*));
+    fifo->head = 0;
+    fifo->size = 0;
+    fifo->capacity = rounded;
+    fifo->arena = arena;
+}
+
+void fifo_grow(ProcessFifo* fifo) {
+    Process** slots = arena_alloc(fifo->arena, (size_t)fifo->capacity * 2 * sizeof(Process*));
+    for (int i = 0; i < fifo->size; i++) {
+        slots[i] = fifo->slots[(fifo->head + i) & (fifo->capacity - 1)];
+    }
+    arena_free(fifo->arena, fifo->slots, (size_t)fifo->capacity * sizeof(Process*));
+    fifo->slots = slots;
+    fifo->head = 0;
+    fifo->capacity *= 2;
+}
+
+SIM_INLINE void fifo_push(ProcessFifo* fifo, Process* process) {
+    if (fifo->size >= fifo->capacity) fifo_grow(fifo);
+    fifo->slots[(fifo->head + fifo->size) & (fifo->capacity - 1)] = process;
+    fifo->size++;
+}
+
+SIM_INLINE Process* fifo_pop(ProcessFifo* fifo) {
+    Process* process = fifo->slots[fifo->head];
+    fifo->head = (fifo->head + 1) & (fifo->capacity - 1);
+    fifo->size--;
+    return process;
+}
+
+SIM_INLINE int find_first_set(uint64_t word) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+// Timing wheel utility functions
+void wheel_reset(TimingWheel* wheel, Arena* arena, Process* processes) {
+    memset(wheel->slots, 0xff, sizeof(wheel->slots));   // All heads -1
+    wheel->processes = processes;
+    memset(wheel->occupied, 0, sizeof(wheel->occupied));
+    wheel->now = 0;
+    wheel->size = 0;
+    wheel->cascades = 0;
+    heap_init(&wheel->due, compare_event);
+    heap_reserve(&wheel->due, arena, 16);
+}
+
+// Link a future event into its slot, relative to the wheel's current time
+SIM_INLINE void wheel_link(TimingWheel* wheel, Process* p) {
+    uint64_t differing = (uint64_t)p->event_time ^ (uint64_t)wheel->now;
+    int level = differing == 0 ? 0 : (63 - __builtin_clzll(differing)) / WHEEL_BITS;
+    int slot = (int)(p->event_time >> (level * WHEEL_BITS)) & (WHEEL_SIZE - 1);
+    int* head = &wheel->slots[level][slot];
+
+    p->event_level = (int8_t)level;
+    p->event_prev = -1;
+    p->event_next = *head;
+    if (*head >= 0) wheel->processes[*head].event_prev = (int)(p - wheel->processes);
+    *head = (int)(p - wheel->processes);
+    wheel->occupied[level][slot / 64] |= (uint64_t)1 << (slot % 64);
+}
+
+SIM_INLINE void wheel_unlink(TimingWheel* wheel, Process* p) {
+    int level = p->event_level;
+    int slot = (int)(p->event_time >> (level * WHEEL_BITS)) & (WHEEL_SIZE - 1);
+    if (p->event_prev >= 0) {
+        wheel->processes[p->event_prev].event_next = p->event_next;
+    } else {
+        wheel->slots[level][slot] = p->event_next;
+        if (p->event_next < 0) wheel->occupied[level][slot / 64] &= ~((uint64_t)1 << (slot % 64));
+    }
+    if (p->event_next >= 0) wheel->processes[p->event_next].event_prev = p->event_prev;
+}
+
+// Add the event of `p` (event_time >= the wheel's time)
+SIM_INLINE void wheel_insert(TimingWheel* wheel, Process* p) {
+    wheel->size++;
+    if (p->event_time == wheel->now) {
+        p->event_level = WHEEL_DUE;
+        heap_insert_with(&wheel->due, p, compare_event);
+    } else {
+        wheel_link(wheel, p);
+    }
+}
+
+SIM_INLINE void wheel_cancel(TimingWheel* wheel, Process* p) {
+    wheel->size--;
+    if (p->event_level == WHEEL_DUE) {
+        heap_remove_with(&wheel->due, p, compare_event);
+    } else {
+        wheel_unlink(wheel, p);
+    }
+}
+
+// Next due event in PID order, NULL once the current instant is done
+SIM_INLINE Process* wheel_pop_due(TimingWheel* wheel) {
+    if (wheel->due.size == 0) return NULL;
+    wheel->size--;
+    return heap_extract_min_with(&wheel->due, compare_event);
+}
+
+// First non-empty slot of `level` at or after `from`; -1 if none
+SIM_INLINE int wheel_find_slot(const TimingWheel* wheel, int level, int from) {
+    for (int w = from / 64; w < WHEEL_WORDS; w++) {
+        uint64_t bits = wheel->occupied[level][w];
+        if (w == from / 64) bits &= ~(uint64_t)0 << (from % 64);
+        if (bits != 0) return w * 64 + find_first_set(bits);
+    }
+    return -1;
+}
+
+// Move the wheel to the next instant with events and make them due; returns that time,
+// or -1 if no event is pending up to `limit`. The wheel never moves past `limit`, so events
+// can still be added from there on.
+int64_t wheel_advance(TimingWheel* wheel, int64_t limit) {
+    if (wheel->due.size > 0) return wheel->now <= limit ? wheel->now : -1;
+    if (wheel->size == 0) return -1;
+
+    while (1) {
+        int slot = wheel_find_slot(wheel, 0, (int)(wheel->now & (WHEEL_SIZE - 1)));
+        if (slot >= 0) {
+            if (((wheel->now & ~(WHEEL_SIZE - 1)) | slot) > limit) return -1;
+            wheel->now = (wheel->now & ~(WHEEL_SIZE - 1)) | slot;
+            int index = wheel->slots[0][slot];
+            wheel->slots[0][slot] = -1;
+            wheel->occupied[0][slot / 64] &= ~((uint64_t)1 << (slot % 64));
+            while (index >= 0) {
+                Process* p = &wheel->processes[index];
+                index = p->event_next;
+                p->event_level = WHEEL_DUE;
+                heap_insert_with(&wheel->due, p, compare_event);
+            }
+            return wheel->now;
+        }
+
+        // Level 0 is empty: jump to the start of the next non-empty slot of the lowest
+        // non-empty level and cascade its events down
+        int level = 1;
+        for (; level < WHEEL_LEVELS; level++) {
+            int shift = level * WHEEL_BITS;
+            slot = wheel_find_slot(wheel, level, (int)((wheel->now >> shift) & (WHEEL_SIZE - 1)) + 1);
+            if (slot < 0) continue;
+
+            int64_t above = level + 1 < WHEEL_LEVELS ? wheel->now >> (shift + WHEEL_BITS) << (shift + WHEEL_BITS) : 0;
+            if ((above | ((int64_t)slot << shift)) > limit) return -1;
+            wheel->now = above | ((int64_t)slot << shift);
+            int index = wheel->slots[level][slot];
+            wheel->slots[level][slot] = -1;
+            wheel->occupied[level][slot / 64] &= ~((uint64_t)1 << (slot % 64));
+            while (index >= 0) {
+                Process* p = &wheel->processes[index];
+                index = p->event_next;
+                wheel_link(wheel, p);
+                INSTR_COUNT(wheel->cascades);
+            }
+            break;
+        }
+        if (level == WHEEL_LEVELS) return -1;   // Unreachable while size counts the linked events
+    }
+}
+
+// Random number utility functions
+SIM_INLINE uint64_t rotl64(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+SIM_INLINE uint64_t splitmix64(uint64_t* state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+void rng_seed(Xoshiro256* rng, uint64_t seed, uint64_t stream) {
+    uint64_t state = seed ^ (stream * 0xd1342543de82ef95ull);
+    state = splitmix64(&state);
+    for (int i = 0; i < 4; i++) rng->s[i] = splitmix64(&state);
+}
+
+SIM_INLINE uint64_t rng_next(Xoshiro256* rng) {
+    uint64_t* s = rng->s;
+    uint64_t result = rotl64(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl64(s[3], 45);
+    return result;
+}
+
+// Uniform in [0, 1)
+SIM_INLINE double rng_uniform(Xoshiro256* rng) {
+    return (double)(rng_next(rng) >> 11) * 0x1.0p-53;
+}
+
+// Uniform integer in [0, range)
+SIM_INLINE uint32_t rng_below(Xoshiro256* rng, uint32_t range) {
+    return (uint32_t)(((rng_next(rng) >> 32) * (uint64_t)range) >> 32);
+}
+
+SIM_INLINE uint64_t rng_below64(Xoshiro256* rng, uint64_t range) {
+    return (uint64_t)(((unsigned __int128)rng_next(rng) * range) >> 64);
+}
+
+// Ready queue utility functions
+
+// Priorities outside the queue's bucket range share the nearest bucket
+SIM_INLINE int priority_level(ReadyQueue* rq, Process* p) {
+    int64_t level = (int64_t)p->priority - rq->bucket_base;
+    if (level < 0) return 0;
+    if (level >= rq->num_buckets) return rq->num_buckets - 1;
+    return (int)level;
+}
+
+SIM_INLINE int priority_first_level(ReadyQueue* rq) {
+    for (int w = 0; w < (rq->num_buckets + 63) / 64; w++) {
+        if (rq->bucket_bitmap[w] != 0) return w * 64 + find_first_set(rq->bucket_bitmap[w]);
+    }
+    return -1;
+}
+
+SIM_INLINE int mlfq_first_level(ReadyQueue* rq) {
+    return find_first_set(rq->level_bitmap);
+}
+
+// Load weight per nice value -20..19 (as in Linux): one nice step is about 10% CPU share
+const int cfs_nice_weights[40] = {
+    88761, 71755, 56483, 46273, 36291, 29154, 23254, 18705, 14949, 11916,
+    9548, 7620, 6100, 4904, 3906, 3121, 2501, 1991, 1586, 1277,
+    1024, 820, 655, 526, 423, 335, 272, 215, 172, 137,
+    110, 87, 70, 56, 45, 36, 29, 23, 18, 15,
+};
+#define CFS_VRUNTIME_SHIFT 20   // vruntime of one time unit at nice 0 (weight 1024) is 2^20
+
+// Priorities map to nice values centred on the middle of the priority range
+SIM_INLINE int cfs_weight(int priority) {
+    int nice = priority - PRIORITY_LEVELS / 2;
+    if (nice < -20) nice = -20;
+    if (nice > 19) nice = 19;
+    return cfs_nice_weights[nice + 20];
+}
+
+// Virtual time of `ran` time units at `weight`
+SIM_INLINE int64_t cfs_vtime(int64_t ran, int weight) {
+    return (ran << (CFS_VRUNTIME_SHIFT + 10)) / weight;
+}
+
+void cfs_tree_init(CfsTree* tree, CfsEntity* entities, Process* processes, int nil) {
+    tree->entities = entities;
+    tree->processes = processes;
+    tree->nil = nil;
+    tree->root = nil;
+    tree->leftmost = nil;
+    tree->min_vruntime = 0;
+    tree->load = 0;
+    tree->rotations = 0;
+}
+
+void cfs_rotate_left(CfsTree* tree, int x) {
+    CfsEntity* e = tree->entities;
+    int y = e[x].right;
+    e[x].right = e[y].left;
+    if (e[y].left != tree->nil) e[e[y].left].parent = x;
+    e[y].parent = e[x].parent;
+    if (e[x].parent == tree->nil) {
+        tree->root = y;
+    } else if (x == e[e[x].parent].left) {
+        e[e[x].parent].left = y;
+    } else {
+        e[e[x].parent].right = y;
+    }
+    e[y].left = x;
+    e[x].parent = y;
+    INSTR_COUNT(tree->rotations);
+}
+
+void cfs_rotate_right(CfsTree* tree, int x) {
+    CfsEntity* e = tree->entities;
+    int y = e[x].left;
+    e[x].left = e[y].right;
+    if (e[y].right != tree->nil) e[e[y].right].parent = x;
+    e[y].parent = e[x].parent;
+    if (e[x].parent == tree->nil) {
+        tree->root = y;
+    } else if (x == e[e[x].parent].right) {
+        e[e[x].parent].right = y;
+    } else {
+        e[e[x].parent].left = y;
+    }
+    e[y].right = x;
+    e[x].parent = y;
+    INSTR_COUNT(tree->rotations);
+}
+
+// O(log n); equal vruntimes queue up behind each other
+void cfs_insert(CfsTree* tree, int x) {
+    CfsEntity* e = tree->entities;
+    int nil = tree->nil;
+    int parent = nil;
+    int cur = tree->root;
+    int leftmost = 1;
+    while (cur != nil) {
+        parent = cur;
+        if (e[x].vruntime < e[cur].vruntime) {
+            cur = e[cur].left;
+        } else {
+            cur = e[cur].right;
+            leftmost = 0;
+        }
+    }
+    e[x].parent = parent;
+    e[x].left = nil;
+    e[x].right = nil;
+    e[x].red = 1;
+    if (parent == nil) {
+        tree->root = x;
+    } else if (e[x].vruntime < e[parent].vruntime) {
+        e[parent].left = x;
+    } else {
+        e[parent].right = x;
+    }
+    if (leftmost) tree->leftmost = x;
+
+    while (e[e[x].parent].red) {
+        int p = e[x].parent;
+        int g = e[p].parent;
+        if (p == e[g].left) {
+            int uncle = e[g].right;
+            if (e[uncle].red) {
+                e[p].red = 0;
+                e[uncle].red = 0;
+                e[g].red = 1;
+                x = g;
+            } else {
+                if (x == e[p].right) {
+                    x = p;
+                    cfs_rotate_left(tree, x);
+                    p = e[x].parent;
+                }
+                e[p].red = 0;
+                e[g].red = 1;
+                cfs_rotate_right(tree, g);
+            }
+        } else {
+            int uncle = e[g].left;
+            if (e[uncle].red) {
+                e[p].red = 0;
+                e[uncle].red = 0;
+                e[g].red = 1;
+                x = g;
+            } else {
+                if (x == e[p].left) {
+                    x = p;
+                    cfs_rotate_right(tree, x);
+                    p = e[x].parent;
+                }
+                e[p].red = 0;
+                e[g].red = 1;
+                cfs_rotate_left(tree, g);
+            }
+        }
+    }
+    e[tree->root].red = 0;
+}
+
+void cfs_transplant(CfsTree* tree, int u, int v) {
+    CfsEntity* e = tree->entities;
+    if (e[u].parent == tree->nil) {
+        tree->root = v;
+    } else if (u == e[e[u].parent].left) {
+        e[e[u].parent].left = v;
+    } else {
+        e[e[u].parent].right = v;
+    }
+    e[v].parent = e[u].parent;     // Also for the sentinel, which the fixup below relies on
+}
+
+int cfs_minimum(const CfsTree* tree, int x) {
+    while (tree->entities[x].left != tree->nil) x = tree->entities[x].left;
+    return x;
+}
+
+void cfs_erase_fixup(CfsTree* tree, int x) {
+    CfsEntity* e = tree->entities;
+    while (x != tree->root && !e[x].red) {
+        int p = e[x].parent;
+        if (x == e[p].left) {
+            int w = e[p].right;
+            if (e[w].red) {
+                e[w].red = 0;
+                e[p].red = 1;
+                cfs_rotate_left(tree, p);
+                w = e[p].right;
+            }
+            if (!e[e[w].left].red && !e[e[w].right].red) {
+                e[w].red = 1;
+                x = p;
+            } else {
+                if (!e[e[w].right].red) {
+                    e[e[w].left].red = 0;
+                    e[w].red = 1;
+                    cfs_rotate_right(tree, w);
+                    w = e[p].right;
+                }
+                e[w].red = e[p].red;
+                e[p].red = 0;
+                e[e[w].right].red = 0;
+                cfs_rotate_left(tree, p);
+                x = tree->root;
+            }
+        } else {
+            int w = e[p].left;
+            if (e[w].red) {
+                e[w].red = 0;
+                e[p].red = 1;
+                cfs_rotate_right(tree, p);
+                w = e[p].left;
+            }
+            if (!e[e[w].right].red && !e[e[w].left].red) {
+                e[w].red = 1;
+                x = p;
+            } else {
+                if (!e[e[w].left].red) {
+                    e[e[w].right].red = 0;
+                    e[w].red = 1;
+                    cfs_rotate_left(tree, w);
+                    w = e[p].left;
+                }
+                e[w].red = e[p].red;
+                e[p].red = 0;
+                e[e[w].left].red = 0;
+                cfs_rotate_right(tree, p);
+                x = tree->root;
+            }
+        }
+    }
+    e[x].red = 0;
+}
+
+// O(log n), amortized O(1) for the leftmost node, whose successor becomes the new cached minimum
+void cfs_erase(CfsTree* tree, int z) {
+    CfsEntity* e = tree->entities;
+    int nil = tree->nil;
+    if (z == tree->leftmost) {
+        // The leftmost node has no left child: its successor is in its right subtree or above it
+        tree->leftmost = e[z].right != nil ? cfs_minimum(tree, e[z].right) : e[z].parent;
+    }
+
+    int y = z;
+    int y_red = e[y].red;
+    int x;
+    if (e[z].left == nil) {
+        x = e[z].right;
+        cfs_transplant(tree, z, e[z].right);
+    } else if (e[z].right == nil) {
+        x = e[z].left;
+        cfs_transplant(tree, z, e[z].left);
+    } else {
+        y = cfs_minimum(tree, e[z].right);
+        y_red = e[y].red;
+        x = e[y].right;
+        if (e[y].parent == z) {
+            e[x].parent = y;
+        } else {
+            cfs_transplant(tree, y, e[y].right);
+            e[y].right = e[z].right;
+            e[e[y].right].parent = y;
+        }
+        cfs_transplant(tree, z, y);
+        e[y].left = e[z].left;
+        e[e[y].left].parent = y;
+        e[y].red = e[z].red;
+    }
+    if (!y_red) cfs_erase_fixup(tree, x);
+}
+
+// Lottery queue utility functions (see ShareQueue)
+void lottery_reset(ShareQueue* queue, Arena* arena, int capacity) {
+    int slots = 16;
+    while (slots < capacity) slots *= 2;
+    queue->arena = arena;
+    queue->capacity = slots;
+    queue->winner = 0;
+    queue->tree = arena_alloc(arena, (size_t)(slots + 1) * sizeof(int64_t));
+    queue->slots = arena_alloc(arena, (size_t)(slots + 1) * sizeof(Process*));
+    memset(queue->tree, 0, (size_t)(slots + 1) * sizeof(int64_t));
+}
+
+// Twice the slots: the new tree nodes cover empty slots, except the last, which covers all
+void lottery_grow(ShareQueue* queue) {
+    int old = queue->capacity;
+    queue->tree = arena_grow(queue->arena, queue->tree, (size_t)(old + 1) * sizeof(int64_t),
+                             (size_t)(2 * old + 1) * sizeof(int64_t));
+    queue->slots = arena_grow(queue->arena, queue->slots, (size_t)(old + 1) * sizeof(Process*),
+                              (size_t)(2 * old + 1) * sizeof(Process*));
+    memset(&queue->tree[old + 1], 0, (size_t)old * sizeof(int64_t));
+    queue->tree[2 * old] = queue->tree[old];
+    queue->capacity = 2 * old;
+}
+
+SIM_INLINE void lottery_add(ShareQueue* queue, int slot, int64_t tickets) {
+    for (; slot <= queue->capacity; slot += slot & -slot) queue->tree[slot] += tickets;
+}
+
+SIM_INLINE void lottery_insert(ShareQueue* queue, int slot, Process* p) {
+    if (slot > queue->capacity) lottery_grow(queue);
+    queue->slots[slot] = p;
+    p->heap_index = slot;
+    lottery_add(queue, slot, queue->tickets[p - queue->processes]);
+    queue->winner = 0;      // The odds changed
+}
+
+// Slot of the next process to dispatch: the one whose tickets hold a uniform draw below the
+// total. Drawn once and kept until the queue changes, so a peek and the pop agree.
+SIM_INLINE int lottery_draw(ShareQueue* queue) {
+    if (queue->winner == 0) {
+        int64_t draw = (int64_t)rng_below64(&queue->rng, (uint64_t)queue->tree[queue->capacity]);
+        int slot = 0;
+        for (int step = queue->capacity / 2; step > 0; step /= 2) {
+            if (queue->tree[slot + step] <= draw) {
+                slot += step;
+                draw -= queue->tree[slot];
+            }
+        }
+        queue->winner = slot + 1;
+    }
+    return queue->winner;
+}
+
+// Take the drawn process out of a queue of `size` processes
+SIM_INLINE Process* lottery_remove(ShareQueue* queue, int size) {
+    int slot = lottery_draw(queue);
+    Process* p = queue->slots[slot];
+    int64_t tickets = queue->tickets[p - queue->processes];
+    if (slot != size) {
+        Process* last = queue->slots[size];
+        int64_t last_tickets = queue->tickets[last - queue->processes];
+        lottery_add(queue, size, -last_tickets);
+        lottery_add(queue, slot, last_tickets - tickets);
+        queue->slots[slot] = last;
+        last->heap_index = slot;
+    } else {
+        lottery_add(queue, slot, -tickets);
+    }
+    p->heap_index = -1;
+    queue->winner = 0;
+    return p;
+}
+
+// `levels`: MLFQ levels in use; `priorities`: lowest and highest priority with a bucket of its own
+void ready_queue_reset(ReadyQueue* rq, enum SchedulingMode mode, Arena* arena, int capacity, int levels,
+                       const int priorities[2]) {
+    rq->mode = mode;
+    rq->size = 0;
+    switch (mode) {
+        case FCFS_MODE:
+        case SJF_MODE:
+            heap_init(&rq->heap, mode == SJF_MODE ? compare_sjf : compare_fcfs);
+            heap_reserve(&rq->heap, arena, capacity);
+            break;
+        case RR_MODE:
+            fifo_reserve(&rq->fifo, arena, capacity);
+            break;
+        case PRIORITY_MODE: {
+            int64_t range = (int64_t)priorities[1] - priorities[0] + 1;
+            rq->bucket_base = priorities[0];
+            rq->num_buckets = range < PRIORITY_MAX_BUCKETS ? (int)range : PRIORITY_MAX_BUCKETS;
+            rq->buckets = arena_alloc(arena, (size_t)rq->num_buckets * sizeof(ProcessHeap));
+            for (int level = 0; level < rq->num_buckets; level++) {
+                heap_init(&rq->buckets[level], compare_priority);
+                heap_reserve(&rq->buckets[level], arena, 16);
+            }
+            size_t bitmap_bytes = (size_t)(rq->num_buckets + 63) / 64 * sizeof(uint64_t);
+            rq->bucket_bitmap = arena_alloc(arena, bitmap_bytes);
+            memset(rq->bucket_bitmap, 0, bitmap_bytes);
+            break;
+        }
+        case MLFQ_MODE:
+            // New processes start at the top; lower levels fill up as they use their quanta
+            for (int level = 0; level < levels; level++) {
+                fifo_reserve(&rq->levels[level], arena, level == 0 ? capacity : 16);
+            }
+            rq->level_bitmap = 0;
+            break;
+        case CFS_MODE:
+            break;      // Trees live on the run's CFS entities (cfs_reset)
+        case EDF_MODE:
+        case RM_MODE:
+            heap_init(&rq->heap, compare_realtime);
+            heap_reserve(&rq->heap, arena, capacity);
+            break;
+        case LOTTERY_MODE:
+            lottery_reset(&rq->share, arena, capacity);     // Tickets and draws: share_reset
+            break;
+        case STRIDE_MODE:
+            heap_init(&rq->heap, compare_stride);
+            heap_reserve(&rq->heap, arena, capacity);
+            break;
+    }
+}
+
+SIM_INLINE void ready_queue_push(ReadyQueue* rq, Process* p, enum SchedulingMode mode) {
+    switch (mode) {
+        case FCFS_MODE:
+            heap_insert_with(&rq->heap, p, compare_fcfs);
+            break;
+        case SJF_MODE:
+            heap_insert_with(&rq->heap, p, compare_sjf);
+            break;
+        case RR_MODE:
+            // Same-time entries arrive in PID order (event order), which keeps the FIFO identical
+            // to ordering by (queue_entry_time, pid)
+            fifo_push(&rq->fifo, p);
+            break;
+        case PRIORITY_MODE: {
+            int level = priority_level(rq, p);
+            heap_insert_with(&rq->buckets[level], p, compare_priority);
+            rq->bucket_bitmap[level / 64] |= (uint64_t)1 << (level % 64);
+            break;
+        }
+        case MLFQ_MODE:
+            fifo_push(&rq->levels[p->mlfq_level], p);
+            rq->level_bitmap |= (uint64_t)1 << p->mlfq_level;
+            break;
+        case CFS_MODE: {
+            int index = (int)(p - rq->cfs.processes);
+            cfs_insert(&rq->cfs, index);
+            rq->cfs.load += rq->cfs.entities[index].weight;
+            break;
+        }
+        case EDF_MODE:
+        case RM_MODE:
+            heap_insert_with(&rq->heap, p, compare_realtime);
+            break;
+        case LOTTERY_MODE:
+            lottery_insert(&rq->share, rq->size + 1, p);
+            break;
+        case STRIDE_MODE: {
+            ShareQueue* share = &rq->share;
+            int64_t* pass = &share->passes[p - share->processes];
+            if (*pass < share->min_pass) *pass = share->min_pass;
+            p->stride_pass = *pass;
+            heap_insert_with(&rq->heap, p, compare_stride);
+            break;
+        }
+    }
+    rq->size++;
+}
+
+// Next process to dispatch, without removing it
+SIM_INLINE Process* ready_queue_peek(ReadyQueue* rq, enum SchedulingMode mode) {
+    if (rq->size == 0) return NULL;
+    switch (mode) {
+        case RR_MODE:
+            return rq->fifo.slots[rq->fifo.head];
+        case PRIORITY_MODE:
+            return rq->buckets[priority_first_level(rq)].heap[0];
+        case MLFQ_MODE: {
+            ProcessFifo* fifo = &rq->levels[mlfq_first_level(rq)];
+            return fifo->slots[fifo->head];
+        }
+        case CFS_MODE:
+            return &rq->cfs.processes[rq->cfs.leftmost];
+        case LOTTERY_MODE:
+            return rq->share.slots[lottery_draw(&rq->share)];
+        default:
+            return rq->heap.heap[0];
+    }
+}
+
+SIM_INLINE Process* ready_queue_pop(ReadyQueue* rq, enum SchedulingMode mode) {
+    if (rq->size == 0) return NULL;
+    Process* p = NULL;
+    switch (mode) {
+        case FCFS_MODE:
+            p = heap_extract_min_with(&rq->heap, compare_fcfs);
+            break;
+        case SJF_MODE:
+            p = heap_extract_min_with(&rq->heap, compare_sjf);
+            break;
+        case RR_MODE:
+            p = fifo_pop(&rq->fifo);
+            break;
+        case PRIORITY_MODE: {
+            int level = priority_first_level(rq);
+            p = heap_extract_min_with(&rq->buckets[level], compare_priority);
+            if (rq->buckets[level].size == 0) {
+                rq->bucket_bitmap[level / 64] &= ~((uint64_t)1 << (level % 64));
+            }
+            break;
+        }
+        case MLFQ_MODE: {
+            int level = mlfq_first_level(rq);
+            p = fifo_pop(&rq->levels[level]);
+            if (rq->levels[level].size == 0) rq->level_bitmap &= ~((uint64_t)1 << level);
+            break;
+        }
+        case CFS_MODE: {
+            int index = rq->cfs.leftmost;
+            CfsEntity* entity = &rq->cfs.entities[index];
+            cfs_erase(&rq->cfs, index);
+            rq->cfs.load -= entity->weight;
+            if (entity->vruntime > rq->cfs.min_vruntime) rq->cfs.min_vruntime = entity->vruntime;
+            p = &rq->cfs.processes[index];
+            break;
+        }
+        case EDF_MODE:
+        case RM_MODE:
+            p = heap_extract_min_with(&rq->heap, compare_realtime);
+            break;
+        case LOTTERY_MODE:
+            p = lottery_remove(&rq->share, rq->size);
+            break;
+        case STRIDE_MODE:
+            p = heap_extract_min_with(&rq->heap, compare_stride);
+            if (p->stride_pass > rq->share.min_pass) rq->share.min_pass = p->stride_pass;
+            break;
+    }
+    rq->size--;
+    return p;
+}
+
+// CPU set utility functions
+SIM_INLINE void cpu_mask_set(CpuMask* mask, int cpu) {
+    mask->bits[cpu / 64] |= (uint64_t)1 << (cpu % 64);
+}
+
+SIM_INLINE void cpu_mask_clear(CpuMask* mask, int cpu) {
+    mask->bits[cpu / 64] &= ~((uint64_t)1 << (cpu % 64));
+}
+
+SIM_INLINE int cpu_mask_test(const CpuMask* mask, int cpu) {
+    return (int)((mask->bits[cpu / 64] >> (cpu % 64)) & 1);
+}
+
+// Lowest CPU in both sets (`filter` NULL: all CPUs); -1 if none
+SIM_INLINE int cpu_mask_first_common(const CpuMask* mask, const CpuMask* filter) {
+    for (int w = 0; w < CPU_MASK_WORDS; w++) {
+        uint64_t bits = mask->bits[w] & (filter != NULL ? filter->bits[w] : ~(uint64_t)0);
+        if (bits != 0) return w * 64 + find_first_set(bits);
+    }
+    return -1;
+}
+
+SIM_INLINE int cpu_allowed(const CpuMask* affinity, int cpu) {
+    return affinity == NULL || cpu_mask_test(affinity, cpu);
+}
+
+void display_menu() {
+    printf("--------------------------------------\n");
+    printf("         CPU SCHEDULING SIMULATOR \n\n");
+    printf("1. Create random processes\n");
+    printf("2. FCFS scheduling\n");
+    printf("3. SJF (Non-Preemptive) scheduling\n");
+    printf("4. SJF (Preemptive) scheduling\n");
+    printf("5. Priority (Non-Preemptive) scheduling\n");
+    printf("6. Priority (Preemptive) scheduling\n");
+    printf("7. Round Robin scheduling\n");
+    printf("8. MLFQ scheduling\n");
+    printf("9. CFS scheduling\n");
+    printf("10. Batch comparison (all algorithms, parallel)\n");
+    printf("0. Exit\n\n");
+    printf("Choice: ");
+}
+
+// Workload utility functions
+void workload_free(Workload* workload) {
+    arena_release(&workload->arena);
+    if (workload->mapping != NULL) {
+        munmap(workload->mapping, workload->mapping_size);
+    }
+    free(workload->affinity);
+    free(workload->arrival_order);
+    free(workload->shares);
+    memset(workload, 0, sizeof(*workload));
+}
+
+typedef struct {
+    int arrival_time;
+    int pid;
+    int index;
+} ArrivalIndex;
+
+int compare_arrival_index(const void* a, const void* b) {
+    const ArrivalIndex* x = a;
+    const ArrivalIndex* y = b;
+    if (x->arrival_time != y->arrival_time) return (x->arrival_time > y->arrival_time) - (x->arrival_time < y->arrival_time);
+    if (x->pid != y->pid) return (x->pid > y->pid) - (x->pid < y->pid);
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+// Arrival order of the records, computed once per workload so runs start without sorting.
+// Records arriving together are ordered by pid, as the ready queues break ties.
+void workload_order_by_arrival(Workload* workload) {
+    int count = workload->count;
+    free(workload->arrival_order);
+    workload->arrival_order = NULL;
+    int sorted = 1;
+    for (int i = 1; i < count && sorted; i++) {
+        const WorkloadRecord* prev = &workload->records[i - 1];
+        const WorkloadRecord* next = &workload->records[i];
+        sorted = prev->arrival_time < next->arrival_time ||
+                 (prev->arrival_time == next->arrival_time && prev->pid <= next->pid);
+    }
+    if (sorted) return;     // Generated arrival processes other than uniform come out in order
+
+    ArrivalIndex* order = malloc((size_t)count * sizeof(ArrivalIndex));
+    workload->arrival_order = malloc((size_t)count * sizeof(int));
+    if (order == NULL || workload->arrival_order == NULL) {
+        arena_out_of_memory((size_t)count * (sizeof(ArrivalIndex) + sizeof(int)));
+    }
+    for (int i = 0; i < count; i++) {
+        order[i].arrival_time = workload->records[i].arrival_time;
+        order[i].pid = workload->records[i].pid;
+        order[i].index = i;
+    }
+    qsort(order, (size_t)count, sizeof(ArrivalIndex), compare_arrival_index);
+    for (int i = 0; i < count; i++) workload->arrival_order[i] = order[i].index;
+    free(order);
+}
+
+typedef struct {
+    int pid;
+    int index;
+} PidIndex;
+
+int compare_pid_index(const void* a, const void* b) {
+    const PidIndex* x = a;
+    const PidIndex* y = b;
+    if (x->pid != y->pid) return x->pid < y->pid ? -1 : 1;
+    return x->index - y->index;
+}
+
+// Record indices of a workload sorted by pid, for the per-pid side tables
+PidIndex* workload_pid_index(const Workload* workload) {
+    PidIndex* by_pid = malloc((size_t)(workload->count > 0 ? workload->count : 1) * sizeof(PidIndex));
+    if (by_pid == NULL) arena_out_of_memory((size_t)workload->count * sizeof(PidIndex));
+    for (int i = 0; i < workload->count; i++) {
+        by_pid[i].pid = workload->records[i].pid;
+        by_pid[i].index = i;
+    }
+    qsort(by_pid, (size_t)workload->count, sizeof(PidIndex), compare_pid_index);
+    return by_pid;
+}
+
+// First entry with `pid`, -1 if none; the records with that pid follow it
+int pid_index_find(const PidIndex* by_pid, int count, int pid) {
+    int lo = 0, hi = count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (by_pid[mid].pid < pid) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < count && by_pid[lo].pid == pid ? lo : -1;
+}
+
+// Memory held by the workload (arena or file mapping)
+size_t workload_memory(const Workload* workload) {
+    return workload->arena.peak_reserved + workload->mapping_size;
+}
+
+// Workload generator
+// Every chunk of GENERATOR_CHUNK processes draws from its own random streams derived from
+// (seed, chunk), so the workload is the same for any thread count.
+SIM_INLINE double rng_exponential(Xoshiro256* rng, double mean) {
+    return -mean * log(1.0 - rng_uniform(rng));
+}
+
+// Standard normal (Marsaglia polar method)
+double rng_normal(Xoshiro256* rng) {
+    double u, v, s;
+    do {
+        u = 2.0 * rng_uniform(rng) - 1.0;
+        v = 2.0 * rng_uniform(rng) - 1.0;
+        s = u * u + v * v;
+    } while (s >= 1.0 || s == 0.0);
+    return u * sqrt(-2.0 * log(s) / s);
+}
+
+// Distributions of generated times
+enum DistributionKind {
+    DIST_UNIFORM,       // Integers in [a, b]
+    DIST_EXPONENTIAL,   // Mean a
+    DIST_LOGNORMAL,     // Log of the value is normal with mean a and standard deviation b
+    DIST_PARETO         // Scale (minimum) a, shape b
+};
+
+typedef struct {
+    enum DistributionKind kind;
+    double a;
+    double b;
+} Distribution;
+
+// Sample rounded to an integer no smaller than `min`
+int distribution_sample(const Distribution* d, Xoshiro256* rng, int min) {
+    double value = 0;
+    switch (d->kind) {
+        case DIST_UNIFORM:
+            value = d->a + rng_below(rng, (uint32_t)(d->b - d->a + 1));
+            break;
+        case DIST_EXPONENTIAL:
+            value = rng_exponential(rng, d->a);
+            break;
+        case DIST_LOGNORMAL:
+            value = exp(d->a + d->b * rng_normal(rng));
+            break;
+        case DIST_PARETO:
+            value = d->a / pow(1.0 - rng_uniform(rng), 1.0 / d->b);
+            break;
+    }
+    if (value < min) return min;
+    if (value > INT_MAX / 2) return INT_MAX / 2;
+    return (int)(value + 0.5);
+}
+
+// Arrival process
+enum ArrivalKind {
+    ARRIVAL_UNIFORM,    // Independent uniform arrival times in [0, max_time]
+    ARRIVAL_POISSON,    // Exponential gaps with mean 1/rate
+    ARRIVAL_ONOFF       // Poisson bursts of mean burst_size processes separated by idle gaps of mean off_gap
+};
+
+typedef struct {
+    enum ArrivalKind kind;
+    int max_time;
+    double rate;
+    double burst_size;
+    double off_gap;
+} ArrivalModel;
+
+typedef struct {
+    uint64_t seed;
+    ArrivalModel arrivals;
+    Distribution cpu_burst;
+    Distribution io_burst;
+    int priority_levels;    // Priorities uniform in [0, priority_levels)
+    int io_count;           // I/O operations per process, RANDOM_IO_COUNT: uniform in [0, MAX_IO_OPERATIONS)
+} GeneratorConfig;
+
+#define RANDOM_IO_COUNT (-1)
+#define GENERATOR_CHUNK 65536   // Processes per chunk; fixes the random streams, not the threading
+
+// Streams of a chunk
+enum { STREAM_IO_COUNT, STREAM_PROCESS };
+
+// Former fixed ranges: arrivals 0~19, CPU bursts 5~24, priorities 0~9, I/O bursts 2~9
+void generator_defaults(GeneratorConfig* config, uint64_t seed) {
+    memset(config, 0, sizeof(*config));
+    config->seed = seed;
+    config->arrivals.kind = ARRIVAL_UNIFORM;
+    config->arrivals.max_time = 19;
+    config->cpu_burst = (Distribution){DIST_UNIFORM, 5, 24};
+    config->io_burst = (Distribution){DIST_UNIFORM, 2, 9};
+    config->priority_levels = PRIORITY_LEVELS;
+    config->io_count = RANDOM_IO_COUNT;
+}
+
+typedef struct {
+    const GeneratorConfig* config;
+    WorkloadRecord* records;
+    IOOperation* io_operations;
+    uint64_t* chunk_io;         // Pass 1: I/O count of each chunk; pass 2: its first I/O entry
+    int64_t* chunk_span;        // Arrival time of the chunk's last process, relative to the chunk start
+    int count;
+    int num_chunks;
+    int pass;
+    int next_chunk;
+    pthread_mutex_t lock;
+} GeneratorJob;
+
+SIM_INLINE int generator_io_count(const GeneratorConfig* config, Xoshiro256* rng) {
+    if (config->io_count != RANDOM_IO_COUNT) return config->io_count;
+    return (int)rng_below(rng, MAX_IO_OPERATIONS);
+}
+
+// Process `index` of the chunk starting at `first`, with its arrival time relative to the
+// chunk; `clock` and `burst_left` carry the arrival process from one call to the next
+// Arrival of a record at chunk-relative time `clock`; past INT_MAX it saturates, and callers
+// go by the clock itself for the chunk's span
+SIM_INLINE int generator_arrival(double clock) {
+    return clock < INT_MAX ? (int)llround(clock) : INT_MAX;
+}
+
+void generator_draw(const GeneratorConfig* config, Xoshiro256* rng, Xoshiro256* io_rng, int index, int first,
+                    double* clock, int* burst_left, WorkloadRecord* r, IOOperation* io) {
+    const ArrivalModel* arrivals = &config->arrivals;
+    r->pid = index + 1;
+
+    switch (arrivals->kind) {
+        case ARRIVAL_UNIFORM:
+            r->arrival_time = (int)rng_below(rng, (uint32_t)arrivals->max_time + 1);
+            break;
+        case ARRIVAL_POISSON:
+            *clock += rng_exponential(rng, 1.0 / arrivals->rate);
+            r->arrival_time = generator_arrival(*clock);
+            break;
+        case ARRIVAL_ONOFF:
+            if (*burst_left == 0) {
+                // Each chunk starts with a burst; later bursts follow an idle gap
+                if (index != first) *clock += rng_exponential(rng, arrivals->off_gap);
+                *burst_left = 1 + (int)rng_exponential(rng, arrivals->burst_size - 1.0);
+            }
+            (*burst_left)--;
+            *clock += rng_exponential(rng, 1.0 / arrivals->rate);
+            r->arrival_time = generator_arrival(*clock);
+            break;
+    }
+    r->cpu_burst_time = distribution_sample(&config->cpu_burst, rng, 1);
+    r->priority = (int)rng_below(rng, (uint32_t)config->priority_levels);
+
+    // 여러 I/O 작업 생성: CPU 실행 시간 내에서 분산
+    int num_io_operations = generator_io_count(config, io_rng);
+    for (int j = 0; j < num_io_operations; j++) {
+        int segment_size = r->cpu_burst_time / (num_io_operations + 1);
+        io[j].request_time = segment_size * (j + 1) + (int)rng_below(rng, (uint32_t)(segment_size / 2 + 1));
+
+        // I/O 요청 시점이 CPU 실행 시간을 초과하지 않도록 조정
+        if (io[j].request_time >= r->cpu_burst_time) {
+            io[j].request_time = r->cpu_burst_time - 1;
+        }
+        io[j].burst_time = distribution_sample(&config->io_burst, rng, 1);
+    }
+    r->io_count = (uint32_t)num_io_operations;
+}
+
+void generate_chunk(GeneratorJob* job, int chunk) {
+    const GeneratorConfig* config = job->config;
+    int first = chunk * GENERATOR_CHUNK;
+    int last = first + GENERATOR_CHUNK < job->count ? first + GENERATOR_CHUNK : job->count;
+    Xoshiro256 io_rng, rng;
+    rng_seed(&io_rng, config->seed, (uint64_t)chunk * 2 + STREAM_IO_COUNT);
+
+    if (job->pass == 1) {
+        uint64_t total = 0;
+        for (int i = first; i < last; i++) total += (uint64_t)generator_io_count(config, &io_rng);
+        job->chunk_io[chunk] = total;
+        return;
+    }
+
+    rng_seed(&rng, config->seed, (uint64_t)chunk * 2 + STREAM_PROCESS);
+    uint64_t io_next = job->chunk_io[chunk];
+    double clock = 0;           // Local arrival time (Poisson and on/off)
+    int burst_left = 0;         // On/off: processes left in the current burst
+
+    for (int i = first; i < last; i++) {
+        WorkloadRecord* r = &job->records[i];
+        generator_draw(config, &rng, &io_rng, i, first, &clock, &burst_left, r, &job->io_operations[io_next]);
+        r->io_first = (uint32_t)io_next;
+        io_next += r->io_count;
+    }
+    job->chunk_span[chunk] = last > first ? llround(clock) : 0;
+}
+
+void* generator_worker(void* arg) {
+    GeneratorJob* job = arg;
+    while (1) {
+        pthread_mutex_lock(&job->lock);
+        int chunk = job->next_chunk++;
+        pthread_mutex_unlock(&job->lock);
+        if (chunk >= job->num_chunks) break;
+        generate_chunk(job, chunk);
+    }
+    return NULL;
+}
+
+void generator_run_pass(GeneratorJob* job, int pass, int num_threads) {
+    job->pass = pass;
+    job->next_chunk = 0;
+    if (num_threads > job->num_chunks) num_threads = job->num_chunks;
+
+    pthread_t threads[64];
+    int started = 0;
+    for (int i = 1; i < num_threads && i < 64; i++) {
+        if (pthread_create(&threads[started], NULL, generator_worker, job) != 0) break;
+        started++;
+    }
+    generator_worker(job);      // This thread takes chunks too
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+// Generate `count` processes on `num_threads` threads. Returns 0 on success.
+int generate_workload(Workload* workload, int count, const GeneratorConfig* config, int num_threads) {
+    workload_free(workload);
+    GeneratorJob job;
+    memset(&job, 0, sizeof(job));
+    job.config = config;
+    job.count = count;
+    job.num_chunks = (count + GENERATOR_CHUNK - 1) / GENERATOR_CHUNK;
+    job.chunk_io = calloc((size_t)job.num_chunks + 1, sizeof(uint64_t));
+    job.chunk_span = calloc((size_t)job.num_chunks + 1, sizeof(int64_t));
+    if (job.chunk_io == NULL || job.chunk_span == NULL) arena_out_of_memory((size_t)job.num_chunks * 16);
+    pthread_mutex_init(&job.lock, NULL);
+
+    // Pass 1: I/O counts per chunk, so every chunk knows where its I/O entries go
+    generator_run_pass(&job, 1, num_threads);
+    uint64_t num_io = 0;
+    for (int c = 0; c < job.num_chunks; c++) {
+        uint64_t chunk_count = job.chunk_io[c];
+        job.chunk_io[c] = num_io;
+        num_io += chunk_count;
+    }
+
+    size_t record_bytes = (size_t)count * sizeof(WorkloadRecord);
+    size_t io_bytes = (size_t)num_io * sizeof(IOOperation);
+    arena_init(&workload->arena, arena_class_size(record_bytes) + arena_class_size(io_bytes));
+    job.records = arena_alloc(&workload->arena, record_bytes);
+    job.io_operations = arena_alloc(&workload->arena, io_bytes > 0 ? io_bytes : sizeof(IOOperation));
+
+    // Pass 2: the processes, with arrival times relative to their chunk
+    generator_run_pass(&job, 2, num_threads);
+    pthread_mutex_destroy(&job.lock);
+
+    int status = 0;
+    if (config->arrivals.kind != ARRIVAL_UNIFORM) {
+        int64_t offset = 0;
+        for (int c = 0; c < job.num_chunks && status == 0; c++) {
+            int first = c * GENERATOR_CHUNK;
+            int last = first + GENERATOR_CHUNK < count ? first + GENERATOR_CHUNK : count;
+            if (offset + job.chunk_span[c] > INT_MAX) {
+                fprintf(stderr, "Generated arrival times exceed %d; use a higher arrival rate\n", INT_MAX);
+                status = -1;
+                break;
+            }
+            for (int i = first; i < last; i++) job.records[i].arrival_time += (int)offset;
+            offset += job.chunk_span[c];
+        }
+    }
+    free(job.chunk_io);
+    free(job.chunk_span);
+
+    workload->records = job.records;
+    workload->io_operations = job.io_operations;
+    workload->count = count;
+    workload->num_io_operations = (size_t)num_io;
+    if (status != 0) {
+        workload_free(workload);
+    } else {
+        workload_order_by_arrival(workload);
+    }
+    return status;
+}
+
+// Parse a distribution: uniform:MIN,MAX  exp:MEAN  lognormal:MU,SIGMA  pareto:SCALE,SHAPE.
+// Returns 0 on success.
+int parse_distribution(const char* text, Distribution* d) {
+    double a = 0, b = 0;
+    char extra;
+    if (sscanf(text, "uniform:%lf,%lf%c", &a, &b, &extra) == 2 && a >= 0 && b >= a && b < INT_MAX / 2) {
+        *d = (Distribution){DIST_UNIFORM, floor(a), floor(b)};
+    } else if (sscanf(text, "exp:%lf%c", &a, &extra) == 1 && a > 0) {
+        *d = (Distribution){DIST_EXPONENTIAL, a, 0};
+    } else if (sscanf(text, "lognormal:%lf,%lf%c", &a, &b, &extra) == 2 && b >= 0) {
+        *d = (Distribution){DIST_LOGNORMAL, a, b};
+    } else if (sscanf(text, "pareto:%lf,%lf%c", &a, &b, &extra) == 2 && a > 0 && b > 0) {
+        *d = (Distribution){DIST_PARETO, a, b};
+    } else {
+        fprintf(stderr, "Invalid distribution '%s' (uniform:MIN,MAX exp:MEAN lognormal:MU,SIGMA pareto:SCALE,SHAPE)\n",
+                text);
+        return -1;
+    }
+    return 0;
+}
+
+// Parse an arrival model: uniform:MAX  poisson:RATE  onoff:RATE,BURST,GAP. Returns 0 on success.
+int parse_arrivals(const char* text, ArrivalModel* arrivals) {
+    double a = 0, b = 0, c = 0;
+    char extra;
+    memset(arrivals, 0, sizeof(*arrivals));
+    if (sscanf(text, "uniform:%lf%c", &a, &extra) == 1 && a >= 0 && a < INT_MAX) {
+        arrivals->kind = ARRIVAL_UNIFORM;
+        arrivals->max_time = (int)a;
+    } else if (sscanf(text, "poisson:%lf%c", &a, &extra) == 1 && a > 0) {
+        arrivals->kind = ARRIVAL_POISSON;
+        arrivals->rate = a;
+    } else if (sscanf(text, "onoff:%lf,%lf,%lf%c", &a, &b, &c, &extra) == 3 && a > 0 && b >= 1 && c >= 0) {
+        arrivals->kind = ARRIVAL_ONOFF;
+        arrivals->rate = a;
+        arrivals->burst_size = b;
+        arrivals->off_gap = c;
+    } else {
+        fprintf(stderr, "Invalid arrivals '%s' (uniform:MAX poisson:RATE onoff:RATE,BURST,GAP)\n", text);
+        return -1;
+    }
+    return 0;
+}
+
+// Generated phases: every process alternates CPU bursts and I/O bursts until its CPU time is
+// used up. A phase is drawn only when the one before ends, from a stream keyed by the process
+// and the CPU time at which it starts, so a process has any number of phases in O(1) memory and
+// every algorithm sees the same ones.
+struct PhaseModel {
+    uint64_t seed;
+    Distribution cpu;       // CPU time between I/O requests
+    Distribution io;        // I/O burst
+};
+
+// Parse phases: CPU_DIST/IO_DIST, e.g. exp:6/uniform:2,9. Returns 0 on success.
+int parse_phases(const char* text, PhaseModel* model) {
+    char cpu[64];
+    const char* slash = strchr(text, '/');
+    if (slash == NULL || (size_t)(slash - text) >= sizeof(cpu)) {
+        fprintf(stderr, "Invalid phases '%s' (CPU_DIST/IO_DIST)\n", text);
+        return -1;
+    }
+    snprintf(cpu, sizeof(cpu), "%.*s", (int)(slash - text), text);
+    if (parse_distribution(cpu, &model->cpu) != 0 || parse_distribution(slash + 1, &model->io) != 0) return -1;
+    return 0;
+}
+
+// Phase of `p` starting after `done` units of CPU time: returns the burst of the I/O requested
+// there and moves the next request to the end of the following CPU burst
+int phase_advance(const PhaseModel* model, Process* p, int done) {
+    uint64_t key = model->seed ^ ((uint64_t)(uint32_t)p->pid << 32 | (uint32_t)p->arrival_time);
+    Xoshiro256 rng;
+    rng_seed(&rng, splitmix64(&key), (uint64_t)done);
+    int burst = distribution_sample(&model->io, &rng, 1);
+    int cpu = distribution_sample(&model->cpu, &rng, 1);
+    p->io_left = cpu < p->cpu_burst_time - done;
+    p->io_next = done + (p->io_left ? cpu : 0);
+    return burst;
+}
+
+// Random workload with the default distributions, reproducible from `seed`
+void generate_random_workload(Workload* workload, int count, uint64_t seed) {
+    GeneratorConfig config;
+    generator_defaults(&config, seed);
+    generate_workload(workload, count, &config, 1);
+}
+
+// Benchmark workload: every process has exactly `io_count` (<= MAX_IO_OPERATIONS) I/O operations
+void generate_benchmark_workload(Workload* workload, int count, int io_count, uint64_t seed, int num_threads) {
+    GeneratorConfig config;
+    generator_defaults(&config, seed);
+    config.io_count = io_count;
+    generate_workload(workload, count, &config, num_threads);
+}
+
+// Map a binary workload file and use its tables in place. Returns 0 on success.
+int workload_load_binary(Workload* workload, const char* path) {
+    workload_free(workload);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open workload file %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < WORKLOAD_HEADER_V1_SIZE) {
+        fprintf(stderr, "Workload file %s is too small\n", path);
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, "Cannot map workload file %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    workload->mapping = mapping;
+    workload->mapping_size = size;
+
+    const WorkloadFileHeader* header = mapping;
+    if (memcmp(header->magic, WORKLOAD_MAGIC, sizeof(header->magic)) != 0 ||
+        header->byte_order != WORKLOAD_BYTE_ORDER) {
+        fprintf(stderr, "%s is not a workload file for this machine\n", path);
+        workload_free(workload);
+        return -1;
+    }
+    if (header->version != 1 && header->version != WORKLOAD_VERSION) {
+        fprintf(stderr, "%s has unsupported workload version %u\n", path, header->version);
+        workload_free(workload);
+        return -1;
+    }
+    uint64_t realtime_offset = header->version >= 2 && size >= sizeof(WorkloadFileHeader) ? header->realtime_offset : 0;
+    if ((header->version >= 2 && size < sizeof(WorkloadFileHeader)) || header->num_processes > INT_MAX ||
+        header->records_offset % 8 != 0 || header->io_offset % 8 != 0 ||
+        header->records_offset > size || header->io_offset > size ||
+        header->num_processes > (size - header->records_offset) / sizeof(WorkloadRecord) ||
+        header->num_io_operations > (size - header->io_offset) / sizeof(IOOperation) ||
+        (realtime_offset != 0 && (realtime_offset % 8 != 0 || realtime_offset > size ||
+                                  header->num_processes > (size - realtime_offset) / sizeof(RealtimeRecord)))) {
+        fprintf(stderr, "Workload file %s is truncated or corrupt\n", path);
+        workload_free(workload);
+        return -1;
+    }
+
+    workload->records = (const WorkloadRecord*)((const char*)mapping + header->records_offset);
+    workload->io_operations = (const IOOperation*)((const char*)mapping + header->io_offset);
+    workload->count = (int)header->num_processes;
+    workload->num_io_operations = header->num_io_operations;
+    if (realtime_offset != 0) {
+        workload->realtime = (const RealtimeRecord*)((const char*)mapping + realtime_offset);
+    }
+
+    // The records get the checks the text importer makes, in one pass without parsing. Generated
+    // workloads may repeat an I/O request time or request at 0, which the engine skips.
+    for (int i = 0; i < workload->count; i++) {
+        const WorkloadRecord* r = &workload->records[i];
+        const char* error = NULL;
+        if (r->arrival_time < 0 || r->cpu_burst_time <= 0) {
+            error = "a negative arrival or a CPU burst that is not positive";
+        } else if (r->io_first > workload->num_io_operations ||
+                   r->io_count > workload->num_io_operations - r->io_first) {
+            error = "an invalid I/O range";
+        } else if (workload->realtime != NULL &&
+                   (workload->realtime[i].deadline < 0 || workload->realtime[i].period < 0 ||
+                    workload->realtime[i].jitter < 0)) {
+            error = "a negative deadline, period or jitter";
+        }
+        int last_request = 0;
+        for (uint32_t k = 0; error == NULL && k < r->io_count; k++) {
+            const IOOperation* op = &workload->io_operations[r->io_first + k];
+            if (op->request_time < last_request || op->request_time >= r->cpu_burst_time || op->burst_time <= 0) {
+                error = "I/O operations out of order or outside the CPU burst";
+            }
+            last_request = op->request_time;
+        }
+        if (error != NULL) {
+            fprintf(stderr, "Workload file %s: process %d has %s\n", path, r->pid, error);
+            workload_free(workload);
+            return -1;
+        }
+    }
+    workload_order_by_arrival(workload);
+    return 0;
+}
+
+int workload_save_binary(const Workload* workload, const char* path) {
+    WorkloadFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, WORKLOAD_MAGIC, sizeof(header.magic));
+    header.version = WORKLOAD_VERSION;
+    header.byte_order = WORKLOAD_BYTE_ORDER;
+    header.num_processes = (uint64_t)workload->count;
+    header.num_io_operations = workload->num_io_operations;
+    header.records_offset = sizeof(WorkloadFileHeader);
+    header.io_offset = header.records_offset + (uint64_t)workload->count * sizeof(WorkloadRecord);
+    if (workload->realtime != NULL) {
+        header.realtime_offset = header.io_offset + workload->num_io_operations * sizeof(IOOperation);
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot create workload file %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(workload->records, sizeof(WorkloadRecord), (size_t)workload->count, file) == (size_t)workload->count &&
+             fwrite(workload->io_operations, sizeof(IOOperation), workload->num_io_operations, file) == workload->num_io_operations &&
+             (workload->realtime == NULL ||
+              fwrite(workload->realtime, sizeof(RealtimeRecord), (size_t)workload->count, file) == (size_t)workload->count);
+    if (fclose(file) != 0) ok = 0;
+    if (!ok) {
+        fprintf(stderr, "Failed to write workload file %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// Parse an integer field ending at `,` `;` `:` or end of line
+int parse_csv_int64(char** cursor, int64_t* value) {
+    char* end;
+    errno = 0;
+    long long parsed = strtoll(*cursor, &end, 10);
+    if (end == *cursor || errno != 0) return 0;
+    while (*end == ' ' || *end == '\t') end++;
+    *value = parsed;
+    *cursor = end;
+    return 1;
+}
+
+int parse_csv_int(char** cursor, int* value) {
+    char* start = *cursor;
+    int64_t parsed;
+    if (!parse_csv_int64(cursor, &parsed)) return 0;
+    if (parsed < INT_MIN || parsed > INT_MAX) {
+        *cursor = start;
+        return 0;
+    }
+    *value = (int)parsed;
+    return 1;
+}
+
+// Start of the data on a text workload line, NULL for blank lines, comments and a header
+char* workload_line_data(char* line, int line_no) {
+    char* cursor = line;
+    while (*cursor == ' ' || *cursor == '\t') cursor++;
+    if (*cursor == '\0' || *cursor == '\n' || *cursor == '\r' || *cursor == '#') return NULL;
+    if (line_no == 1 && (*cursor < '0' || *cursor > '9') && *cursor != '-') return NULL;   // header
+    return cursor;
+}
+
+// One text workload line into `r` (all but io_first), `io`, which has room for `max_io`
+// operations, and `rt` (NULL: the line may not have real-time fields). A streamed line's
+// arrival goes to `arrival` and may be any 64-bit time; with `arrival` NULL it must fit the
+// record. Returns 0 on success, otherwise reports the line.
+int parse_workload_line(char* cursor, const char* path, int line_no, WorkloadRecord* r, int64_t* arrival,
+                        IOOperation* io, int max_io, RealtimeRecord* rt) {
+    int64_t fields[4] = {0, 0, 0, 0};
+    for (int f = 0; f < 4; f++) {
+        if (!parse_csv_int64(&cursor, &fields[f]) || (f < 3 && *cursor++ != ',') ||
+            (f != 1 && (fields[f] < INT_MIN || fields[f] > INT_MAX))) {
+            fields[2] = 0;
+            break;
+        }
+    }
+    if (fields[2] > 0 && *cursor != ',' && *cursor != '\0' && *cursor != '\n' && *cursor != '\r') {
+        fprintf(stderr, "%s:%d: unexpected text after the priority\n", path, line_no);
+        return -1;
+    }
+    if (fields[1] < 0 || fields[2] <= 0) {
+        fprintf(stderr, "%s:%d: expected pid,arrival,cpu_burst,priority with arrival >= 0 and cpu_burst > 0\n",
+                path, line_no);
+        return -1;
+    }
+    if (arrival == NULL && fields[1] > INT_MAX) {
+        fprintf(stderr, "%s:%d: arrival after %d, the latest a workload record holds\n", path, line_no, INT_MAX);
+        return -1;
+    }
+    if (arrival != NULL) *arrival = fields[1];
+    r->pid = (int32_t)fields[0];
+    r->arrival_time = arrival != NULL ? 0 : (int32_t)fields[1];
+    r->cpu_burst_time = (int32_t)fields[2];
+    r->priority = (int32_t)fields[3];
+    r->io_count = 0;
+
+    if (*cursor == ',') {
+        cursor++;
+        int last_request = 0;
+        while (1) {
+            while (*cursor == ' ' || *cursor == '\t') cursor++;
+            if (*cursor == '\0' || *cursor == '\n' || *cursor == '\r' || *cursor == ',') break;
+
+            IOOperation op;
+            if (!parse_csv_int(&cursor, &op.request_time) || *cursor++ != ':' ||
+                !parse_csv_int(&cursor, &op.burst_time) ||
+                op.request_time <= last_request || op.request_time >= r->cpu_burst_time || op.burst_time <= 0) {
+                fprintf(stderr, "%s:%d: I/O operations must be request:burst pairs with increasing "
+                                "request times inside the CPU burst\n", path, line_no);
+                return -1;
+            }
+            if ((int)r->io_count >= max_io) {
+                fprintf(stderr, "%s:%d: more than %d I/O operations\n", path, line_no, max_io);
+                return -1;
+            }
+            last_request = op.request_time;
+            io[r->io_count++] = op;
+            if (*cursor == ';') cursor++;
+        }
+    }
+    // Deadline and period, either may be empty; a periodic process without a deadline has the period
+    if (rt != NULL) memset(rt, 0, sizeof(*rt));
+    if (*cursor == ',') {
+        int values[2] = {0, 0};
+        for (int f = 0; f < 2 && *cursor == ','; f++) {
+            cursor++;
+            while (*cursor == ' ' || *cursor == '\t') cursor++;
+            if (*cursor == ',' || *cursor == '\0' || *cursor == '\n' || *cursor == '\r') continue;
+            if (!parse_csv_int(&cursor, &values[f]) || values[f] <= 0) values[f] = -1;
+        }
+        while (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' || *cursor == '\n') cursor++;
+        if (values[0] < 0 || values[1] < 0 || *cursor != '\0') {
+            fprintf(stderr, "%s:%d: expected deadline[,period] after the I/O operations, positive or empty\n",
+                    path, line_no);
+            return -1;
+        }
+        if (rt == NULL && (values[0] > 0 || values[1] > 0)) {
+            fprintf(stderr, "%s:%d: deadlines and periods are not supported with --stream\n", path, line_no);
+            return -1;
+        }
+        if (rt != NULL) {
+            rt->deadline = values[0] > 0 ? values[0] : values[1];
+            rt->period = values[1];
+        }
+    }
+    return 0;
+}
+
+// Reject a pid given to two records, unless both are jobs of a periodic task (they have a period)
+int workload_check_pids(const Workload* workload, const char* path) {
+    int ascending = 1;
+    for (int i = 1; i < workload->count && ascending; i++) {
+        ascending = workload->records[i - 1].pid < workload->records[i].pid;
+    }
+    if (ascending) return 0;
+
+    PidIndex* by_pid = workload_pid_index(workload);
+    const RealtimeRecord* rt = workload->realtime;
+    int duplicate = -1;
+    for (int i = 1; i < workload->count && duplicate < 0; i++) {
+        if (by_pid[i].pid == by_pid[i - 1].pid &&
+            (rt == NULL || rt[by_pid[i].index].period == 0 || rt[by_pid[i - 1].index].period == 0)) {
+            duplicate = by_pid[i].pid;
+        }
+    }
+    free(by_pid);
+    if (duplicate < 0) return 0;
+    fprintf(stderr, "%s: pid %d is used by more than one process\n", path, duplicate);
+    return -1;
+}
+
+// Import a text workload, one process per line:
+//   pid,arrival,cpu_burst,priority[,request:burst;request:burst;...[,deadline[,period]]]
+// I/O request times are CPU times, strictly increasing and inside the CPU burst. The deadline
+// is relative to the arrival; a period makes the process a job of periodic task pid.
+// Blank lines, lines starting with '#' and a header line are skipped. Returns 0 on success.
+int workload_import_csv(Workload* workload, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    workload_free(workload);
+    arena_init(&workload->arena, ARENA_DEFAULT_BLOCK);
+    int record_capacity = 1024;
+    size_t io_capacity = 1024;
+    WorkloadRecord* records = arena_alloc(&workload->arena, (size_t)record_capacity * sizeof(WorkloadRecord));
+    IOOperation* io_operations = arena_alloc(&workload->arena, io_capacity * sizeof(IOOperation));
+    RealtimeRecord* realtime = NULL;    // Allocated at the first line with real-time fields
+    int count = 0;
+    size_t num_io = 0;
+
+    char* line = NULL;
+    size_t line_capacity = 0;
+    int line_no = 0;
+    int error = 0;
+
+    ssize_t length;
+    while (!error && (length = getline(&line, &line_capacity, file)) != -1) {
+        line_no++;
+        char* cursor = workload_line_data(line, line_no);
+        if (cursor == NULL) continue;
+
+        // Every I/O operation takes at least four characters ("1:1;")
+        if (num_io + (size_t)length / 4 + 1 > io_capacity) {
+            size_t capacity = io_capacity;
+            while (num_io + (size_t)length / 4 + 1 > capacity) capacity *= 2;
+            io_operations = arena_grow(&workload->arena, io_operations, io_capacity * sizeof(IOOperation),
+                                       capacity * sizeof(IOOperation));
+            io_capacity = capacity;
+        }
+        WorkloadRecord r;
+        RealtimeRecord rt;
+        if (parse_workload_line(cursor, path, line_no, &r, NULL, &io_operations[num_io], INT_MAX, &rt) != 0) {
+            error = 1;
+            break;
+        }
+        r.io_first = (uint32_t)num_io;
+        num_io += r.io_count;
+
+        if (count >= record_capacity) {
+            records = arena_grow(&workload->arena, records, (size_t)record_capacity * sizeof(WorkloadRecord),
+                                 (size_t)record_capacity * 2 * sizeof(WorkloadRecord));
+            if (realtime != NULL) {
+                realtime = arena_grow(&workload->arena, realtime, (size_t)record_capacity * sizeof(RealtimeRecord),
+                                      (size_t)record_capacity * 2 * sizeof(RealtimeRecord));
+            }
+            record_capacity *= 2;
+        }
+        if (realtime == NULL && (rt.deadline > 0 || rt.period > 0)) {
+            realtime = arena_alloc(&workload->arena, (size_t)record_capacity * sizeof(RealtimeRecord));
+            memset(realtime, 0, (size_t)count * sizeof(RealtimeRecord));
+        }
+        if (realtime != NULL) realtime[count] = rt;
+        records[count++] = r;
+    }
+
+    free(line);
+    fclose(file);
+    if (error) {
+        workload_free(workload);
+        return -1;
+    }
+
+    workload->records = records;
+    workload->io_operations = io_operations;
+    workload->count = count;
+    workload->num_io_operations = num_io;
+    workload->realtime = realtime;
+    if (workload_check_pids(workload, path) != 0) {
+        workload_free(workload);
+        return -1;
+    }
+    workload_order_by_arrival(workload);
+    return 0;
+}
+
+typedef struct {
+    int pid;
+    int period;
+    int cpu_burst;
+    int priority;
+    int deadline;       // Relative to the release
+    int jitter;         // Largest delay of an arrival after its release
+} TaskSpec;
+
+// Load a periodic task set, one task per line:
+//   pid,period,cpu_burst,priority[,deadline[,jitter]]
+// Every task releases a job (a record with the task's pid) each period from time 0 until
+// `horizon`, 0 for the hyperperiod. A job arrives up to `jitter` after its release, drawn from
+// `seed`, and is due `deadline` after the release (default: the period). Returns 0 on success.
+int workload_load_task_set(Workload* workload, const char* path, int horizon, uint64_t seed) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    int num_tasks = 0, task_capacity = 64;
+    TaskSpec* tasks = malloc((size_t)task_capacity * sizeof(TaskSpec));
+    if (tasks == NULL) arena_out_of_memory((size_t)task_capacity * sizeof(TaskSpec));
+
+    char* line = NULL;
+    size_t line_capacity = 0;
+    int line_no = 0;
+    int error = 0;
+    while (!error && getline(&line, &line_capacity, file) != -1) {
+        line_no++;
+        char* cursor = workload_line_data(line, line_no);
+        if (cursor == NULL) continue;
+
+        int fields[6] = {0, 0, 0, 0, 0, 0};
+        int num_fields = 0;
+        while (num_fields < 6 && parse_csv_int(&cursor, &fields[num_fields])) {
+            num_fields++;
+            if (*cursor != ',') break;
+            cursor++;
+        }
+        while (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' || *cursor == '\n') cursor++;
+        TaskSpec task = {fields[0], fields[1], fields[2], fields[3], num_fields > 4 ? fields[4] : fields[1],
+                         fields[5]};
+        if (num_fields < 4 || *cursor != '\0' || task.period <= 0 || task.cpu_burst <= 0 || task.deadline <= 0 ||
+            task.jitter < 0 || task.jitter >= task.deadline) {
+            fprintf(stderr, "%s:%d: expected pid,period,cpu_burst,priority[,deadline[,jitter]] with positive "
+                            "period, burst and deadline and 0 <= jitter < deadline\n", path, line_no);
+            error = 1;
+            break;
+        }
+        if (num_tasks == task_capacity) {
+            task_capacity *= 2;
+            tasks = realloc(tasks, (size_t)task_capacity * sizeof(TaskSpec));
+            if (tasks == NULL) arena_out_of_memory((size_t)task_capacity * sizeof(TaskSpec));
+        }
+        tasks[num_tasks++] = task;
+    }
+    free(line);
+    fclose(file);
+    if (!error && num_tasks == 0) {
+        fprintf(stderr, "%s has no tasks\n", path);
+        error = 1;
+    }
+
+    // Hyperperiod: least common multiple of the periods
+    if (!error && horizon == 0) {
+        int64_t hyperperiod = 1;
+        for (int i = 0; i < num_tasks && hyperperiod <= INT_MAX; i++) {
+            int64_t a = hyperperiod, b = tasks[i].period;
+            while (b != 0) {
+                int64_t t = a % b;
+                a = b;
+                b = t;
+            }
+            hyperperiod = hyperperiod / a * tasks[i].period;
+        }
+        if (hyperperiod > INT_MAX) {
+            fprintf(stderr, "The hyperperiod of %s exceeds %d; choose a --horizon\n", path, INT_MAX);
+            error = 1;
+        }
+        horizon = (int)hyperperiod;
+    }
+
+    int64_t num_jobs = 0;
+    for (int i = 0; i < num_tasks && !error; i++) {
+        num_jobs += ((int64_t)horizon + tasks[i].period - 1) / tasks[i].period;
+        if (num_jobs > INT_MAX || (int64_t)horizon + tasks[i].jitter > INT_MAX) {
+            fprintf(stderr, "%s: too many jobs or arrivals beyond %d up to t=%d\n", path, INT_MAX, horizon);
+            error = 1;
+        }
+    }
+    if (error) {
+        free(tasks);
+        return -1;
+    }
+
+    workload_free(workload);
+    arena_init(&workload->arena, ARENA_DEFAULT_BLOCK);
+    WorkloadRecord* records = arena_alloc(&workload->arena, (size_t)(num_jobs > 0 ? num_jobs : 1) * sizeof(WorkloadRecord));
+    RealtimeRecord* realtime = arena_alloc(&workload->arena, (size_t)(num_jobs > 0 ? num_jobs : 1) * sizeof(RealtimeRecord));
+    int count = 0, jittered = 0;
+    for (int i = 0; i < num_tasks; i++) {
+        const TaskSpec* task = &tasks[i];
+        Xoshiro256 rng;
+        rng_seed(&rng, seed, (uint64_t)i);     // Its own stream, so a task's jobs do not depend on the others
+        for (int64_t release = 0; release < horizon; release += task->period) {
+            int jitter = task->jitter > 0 ? (int)rng_below(&rng, (uint32_t)task->jitter + 1) : 0;
+            WorkloadRecord* r = &records[count];
+            r->pid = task->pid;
+            r->arrival_time = (int)release + jitter;
+            r->cpu_burst_time = task->cpu_burst;
+            r->priority = task->priority;
+            r->io_first = 0;
+            r->io_count = 0;
+            realtime[count].deadline = task->deadline - jitter;
+            realtime[count].period = task->period;
+            realtime[count].jitter = jitter;
+            count++;
+        }
+        jittered |= task->jitter > 0;
+    }
+    free(tasks);
+
+    workload->records = records;
+    workload->io_operations = arena_alloc(&workload->arena, sizeof(IOOperation));
+    workload->count = count;
+    workload->num_io_operations = 0;
+    workload->realtime = realtime;
+    workload_order_by_arrival(workload);
+    fprintf(stderr, "Task set: %d tasks, %d jobs up to t=%d", num_tasks, count, horizon);
+    if (jittered) fprintf(stderr, ", jitter seed %llu", (unsigned long long)seed);
+    fprintf(stderr, "\n");
+    return 0;
+}
+
+// Schedulability analysis of the periodic tasks of a workload, from their jobs' records
+#define RTA_MAX_TASKS 4096      // Response-time analysis is quadratic in the number of tasks
+
+typedef struct {
+    int pid;
+    int period;
+    int deadline;       // Shortest deadline of its jobs, relative to their arrivals
+    int jitter;         // Largest release jitter of its jobs
+    int wcet;           // Largest CPU burst of its jobs
+} RealtimeTask;
+
+int compare_realtime_task(const void* a, const void* b) {
+    const RealtimeTask* x = a;
+    const RealtimeTask* y = b;
+    if (x->period != y->period) return x->period < y->period ? -1 : 1;    // Rate-monotonic order
+    return x->pid < y->pid ? -1 : x->pid > y->pid;
+}
+
+// Shortest time between two arrivals of the task
+SIM_INLINE double task_separation(const RealtimeTask* task) {
+    return task->period > task->jitter ? task->period - task->jitter : 1;
+}
+
+// Response-time analysis of fixed priorities in rate-monotonic order (tasks sorted by period;
+// equal periods count as higher priority both ways). Returns the index of the first task whose
+// worst-case response exceeds its deadline (or period), -1 if none; `*response` is its response.
+int response_time_analysis(const RealtimeTask* tasks, int num_tasks, int64_t* response) {
+    int group_end = 0;
+    for (int i = 0; i < num_tasks; i++) {
+        if (group_end <= i) {
+            group_end = i + 1;
+            while (group_end < num_tasks && tasks[group_end].period == tasks[i].period) group_end++;
+        }
+        int64_t limit = tasks[i].deadline < tasks[i].period ? tasks[i].deadline : tasks[i].period;
+        int64_t r = tasks[i].wcet, previous = 0;
+        while (r != previous && r <= limit) {
+            previous = r;
+            r = tasks[i].wcet;
+            for (int j = 0; j < group_end; j++) {
+                if (j == i) continue;
+                r += ((previous + tasks[j].jitter + tasks[j].period - 1) / tasks[j].period) * tasks[j].wcet;
+            }
+        }
+        if (r > limit) {
+            *response = r;
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Print the analysis of the workload's periodic tasks on `num_cpus` CPUs: utilization-based
+// tests, and on one CPU the Liu-Layland bound and exact response-time analysis for RM
+void realtime_analysis(const Workload* workload, int num_cpus, FILE* out) {
+    const RealtimeRecord* realtime = workload->realtime;
+    int num_jobs = 0, aperiodic = 0;
+    for (int i = 0; i < workload->count; i++) {
+        num_jobs += realtime[i].period > 0;
+        aperiodic += realtime[i].period <= 0 && realtime[i].deadline > 0;
+    }
+    RealtimeTask* tasks = malloc((size_t)(num_jobs > 0 ? num_jobs : 1) * sizeof(RealtimeTask));
+    if (tasks == NULL) arena_out_of_memory((size_t)num_jobs * sizeof(RealtimeTask));
+    int num_tasks = 0;
+    for (int i = 0; i < workload->count; i++) {
+        const RealtimeRecord* rt = &realtime[i];
+        if (rt->period <= 0) continue;
+        int deadline = rt->deadline > 0 ? rt->deadline : rt->period;
+        tasks[num_tasks++] = (RealtimeTask){workload->records[i].pid, rt->period, deadline, rt->jitter,
+                                            workload->records[i].cpu_burst_time};
+    }
+    // One entry per task: jobs sharing pid and period
+    qsort(tasks, (size_t)num_tasks, sizeof(RealtimeTask), compare_realtime_task);
+    int merged = 0;
+    for (int i = 0; i < num_tasks; i++) {
+        RealtimeTask* last = merged > 0 ? &tasks[merged - 1] : NULL;
+        if (last != NULL && last->pid == tasks[i].pid && last->period == tasks[i].period) {
+            if (tasks[i].deadline < last->deadline) last->deadline = tasks[i].deadline;
+            if (tasks[i].jitter > last->jitter) last->jitter = tasks[i].jitter;
+            if (tasks[i].wcet > last->wcet) last->wcet = tasks[i].wcet;
+        } else {
+            tasks[merged++] = tasks[i];
+        }
+    }
+    num_tasks = merged;
+
+    fprintf(out, "\n--- Schedulability: %d periodic tasks (%d jobs)", num_tasks, num_jobs);
+    if (aperiodic > 0) fprintf(out, ", %d aperiodic processes with deadlines (not analysed)", aperiodic);
+    fprintf(out, " ---\n");
+    if (num_tasks == 0) {
+        free(tasks);
+        return;
+    }
+
+    // Utilization over the period, and over the shortest arrival separation and deadline
+    double utilization = 0, density = 0, max_density = 0;
+    int implicit = 1, jitter = 0;
+    for (int i = 0; i < num_tasks; i++) {
+        double separation = task_separation(&tasks[i]);
+        double window = tasks[i].deadline < separation ? tasks[i].deadline : separation;
+        double task_density = tasks[i].wcet / window;
+        utilization += (double)tasks[i].wcet / tasks[i].period;
+        density += task_density;
+        if (task_density > max_density) max_density = task_density;
+        if (tasks[i].deadline < separation) implicit = 0;
+        if (tasks[i].jitter > 0) jitter = 1;
+    }
+    fprintf(out, "Utilization %.3f, density %.3f (largest task %.3f) on %d CPU%s\n", utilization, density,
+            max_density, num_cpus, num_cpus > 1 ? "s" : "");
+    int m = num_cpus;
+    if (utilization > m) {
+        fprintf(out, "EDF, RM: overloaded (utilization above %d), deadlines will be missed\n", m);
+        free(tasks);
+        return;
+    }
+
+    if (m == 1) {
+        // Density <= 1 is sufficient for EDF, and necessary too without jitter and with deadlines
+        // no shorter than the periods
+        int exact = implicit && !jitter;
+        fprintf(out, "EDF: %s (density %s 1%s)\n",
+                density <= 1 ? "schedulable" : exact ? "not schedulable" : "not guaranteed",
+                density <= 1 ? "<=" : ">", exact ? "" : ", sufficient test");
+
+        double bound = num_tasks * (pow(2.0, 1.0 / num_tasks) - 1);
+        if (implicit && density <= bound) {
+            fprintf(out, "RM: schedulable (Liu-Layland bound %.3f)\n", bound);
+        } else if (num_tasks > RTA_MAX_TASKS) {
+            fprintf(out, "RM: not guaranteed by the Liu-Layland bound %.3f; response-time analysis skipped "
+                         "above %d tasks\n", bound, RTA_MAX_TASKS);
+        } else {
+            int64_t response = 0;
+            int failed = response_time_analysis(tasks, num_tasks, &response);
+            if (failed < 0) {
+                fprintf(out, "RM: schedulable (response-time analysis; Liu-Layland bound %.3f)\n", bound);
+            } else {
+                const RealtimeTask* task = &tasks[failed];
+                fprintf(out, "RM: not schedulable (task %d, period %d: response time %lld > deadline %d)\n",
+                        task->pid, task->period, (long long)response,
+                        task->deadline < task->period ? task->deadline : task->period);
+            }
+        }
+    } else {
+        // Global scheduling bounds (Goossens-Funk-Baruah for EDF, Bertogna-Cirinei-Lipari for
+        // RM); per-CPU queues with stealing only approximate global scheduling
+        double edf_bound = m - (m - 1) * max_density;
+        double rm_bound = m / 2.0 * (1 - max_density) + max_density;
+        fprintf(out, "EDF: %s (density %.3f, global bound %.3f)\n", density <= edf_bound ? "schedulable" : "not guaranteed",
+                density, edf_bound);
+        fprintf(out, "RM: %s (density %.3f, global bound %.3f)\n", density <= rm_bound ? "schedulable" : "not guaranteed",
+                density, rm_bound);
+    }
+    free(tasks);
+}
+
+// Parse a CPU list such as "0-3,8,10-11" into `mask`. Returns 0 on success.
+int parse_cpu_list(const char* text, CpuMask* mask, int num_cpus) {
+    memset(mask, 0, sizeof(*mask));
+    const char* cursor = text;
+    while (1) {
+        char* end;
+        long first = strtol(cursor, &end, 10);
+        if (end == cursor) return -1;
+        long last = first;
+        if (*end == '-') {
+            cursor = end + 1;
+            last = strtol(cursor, &end, 10);
+            if (end == cursor) return -1;
+        }
+        if (first < 0 || last < first || last >= num_cpus) return -1;
+        for (long cpu = first; cpu <= last; cpu++) cpu_mask_set(mask, (int)cpu);
+        if (*end != ',') {
+            cursor = end;
+            break;
+        }
+        cursor = end + 1;
+    }
+    while (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' || *cursor == '\n') cursor++;
+    return *cursor == '\0' ? 0 : -1;
+}
+
+// Load CPU affinity masks, one process per line: pid:cpu-list (e.g. "7:0-3,8").
+// Processes without a line may run on any of the `num_cpus` CPUs; a line applies to every
+// process with that pid. Returns 0 on success.
+int workload_load_affinity(Workload* workload, const char* path, int num_cpus) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    CpuMask all;
+    memset(&all, 0, sizeof(all));
+    for (int cpu = 0; cpu < num_cpus; cpu++) cpu_mask_set(&all, cpu);
+    CpuMask* affinity = malloc((size_t)(workload->count > 0 ? workload->count : 1) * sizeof(CpuMask));
+    if (affinity == NULL) arena_out_of_memory((size_t)workload->count * sizeof(CpuMask));
+    for (int i = 0; i < workload->count; i++) affinity[i] = all;
+    PidIndex* by_pid = workload_pid_index(workload);
+
+    char* line = NULL;
+    size_t line_capacity = 0;
+    int line_no = 0;
+    int error = 0;
+    while (!error && getline(&line, &line_capacity, file) != -1) {
+        line_no++;
+        char* cursor = line;
+        while (*cursor == ' ' || *cursor == '\t') cursor++;
+        if (*cursor == '\0' || *cursor == '\n' || *cursor == '\r' || *cursor == '#') continue;
+
+        int pid;
+        CpuMask mask;
+        if (!parse_csv_int(&cursor, &pid) || *cursor++ != ':' || parse_cpu_list(cursor, &mask, num_cpus) != 0) {
+            fprintf(stderr, "%s:%d: expected pid:cpu-list with CPUs below %d\n", path, line_no, num_cpus);
+            error = 1;
+            break;
+        }
+
+        int first = pid_index_find(by_pid, workload->count, pid);
+        if (first < 0) {
+            fprintf(stderr, "%s:%d: no process with pid %d in the workload\n", path, line_no, pid);
+            error = 1;
+            break;
+        }
+        for (int i = first; i < workload->count && by_pid[i].pid == pid; i++) {
+            affinity[by_pid[i].index] = mask;
+        }
+    }
+
+    free(line);
+    free(by_pid);
+    fclose(file);
+    if (error) {
+        free(affinity);
+        return -1;
+    }
+    free(workload->affinity);
+    workload->affinity = affinity;
+    return 0;
+}
+
+// Load lottery and stride tickets, one process per line: pid:tickets (1-SHARE_MAX_TICKETS).
+// Processes without a line get the CFS weight of their priority, so a nice-0 process holds 1024;
+// a line applies to every process with that pid. Returns 0 on success.
+int workload_load_shares(Workload* workload, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    int* shares = malloc((size_t)(workload->count > 0 ? workload->count : 1) * sizeof(int));
+    if (shares == NULL) arena_out_of_memory((size_t)workload->count * sizeof(int));
+    for (int i = 0; i < workload->count; i++) shares[i] = cfs_weight(workload->records[i].priority);
+    PidIndex* by_pid = workload_pid_index(workload);
+
+    char* line = NULL;
+    size_t line_capacity = 0;
+    int line_no = 0;
+    int error = 0;
+    while (!error && getline(&line, &line_capacity, file) != -1) {
+        line_no++;
+        char* cursor = line;
+        while (*cursor == ' ' || *cursor == '\t') cursor++;
+        if (*cursor == '\0' || *cursor == '\n' || *cursor == '\r' || *cursor == '#') continue;
+
+        int pid, tickets;
+        if (!parse_csv_int(&cursor, &pid) || *cursor++ != ':' || !parse_csv_int(&cursor, &tickets) ||
+            tickets < 1 || tickets > SHARE_MAX_TICKETS ||
+            (*cursor != '\0' && *cursor != '\n' && *cursor != '\r')) {
+            fprintf(stderr, "%s:%d: expected pid:tickets with 1-%d tickets\n", path, line_no, SHARE_MAX_TICKETS);
+            error = 1;
+            break;
+        }
+        int first = pid_index_find(by_pid, workload->count, pid);
+        if (first < 0) {
+            fprintf(stderr, "%s:%d: no process with pid %d in the workload\n", path, line_no, pid);
+            error = 1;
+            break;
+        }
+        for (int i = first; i < workload->count && by_pid[i].pid == pid; i++) {
+            shares[by_pid[i].index] = tickets;
+        }
+    }
+
+    free(line);
+    free(by_pid);
+    fclose(file);
+    if (error) {
+        free(shares);
+        return -1;
+    }
+    free(workload->shares);
+    workload->shares = shares;
+    return 0;
+}
+
+// Linux scheduler trace import (--sched-trace)
+// Text output of ftrace or `perf sched script` with sched_switch and sched_wakeup events is read
+// in one pass over a read-only mapping, and every task becomes one process. Its CPU burst is
+// the time it spent switched in; every interval it was blocked (switched out in a state other
+// than R, until its wakeup) becomes an I/O operation at the CPU time it had used by then.
+// Consumed pages are dropped during the pass, so a trace of any size needs memory only for
+// the tasks and their I/O operations.
+#define SCHED_TRACE_MAX_TID (1 << 22)           // PID_MAX_LIMIT of Linux
+#define SCHED_TRACE_DROP_BYTES (64 << 20)       // Consumed mapping is released in steps of this size
+#define SCHED_IO_NONE UINT32_MAX
+
+enum { SCHED_TASK_READY, SCHED_TASK_RUNNING, SCHED_TASK_BLOCKED };
+
+typedef struct {
+    int64_t arrival;        // Nanoseconds; first wakeup or switch-in
+    int64_t since;          // Start of the current run or block
+    int64_t cpu;            // CPU time so far
+    int32_t tid;
+    int32_t prio;           // Kernel priority: 0-99 real-time, 100-139 nice -20..19
+    int8_t state;
+    int8_t ran;             // Switched in at least once
+    int32_t next_free;      // Free task slots
+    uint32_t io_head;       // Blocked intervals in the import's I/O list
+    uint32_t io_tail;
+} SchedTask;
+
+typedef struct {
+    IOOperation op;
+    uint32_t next;
+} SchedIo;
+
+typedef struct {
+    int64_t tick;               // Nanoseconds per simulated time unit
+    int64_t start;              // First event, -1 before it
+    int64_t last;
+    int* task_of_tid;           // Live task per tid, -1: none
+    SchedTask* tasks;
+    int num_tasks;
+    int task_capacity;
+    int free_task;
+    SchedIo* io;
+    size_t num_io;
+    size_t io_capacity;
+    WorkloadRecord* records;    // io_first is the head of the I/O list until the end of the pass
+    int count;
+    int record_capacity;
+    Arena* arena;
+    int max_cpu;
+    uint64_t events;
+    uint64_t unresolved_blocks; // Blocks shorter than a time unit or before one time unit of CPU
+} SchedTraceImport;
+
+// Position of `text` in [from, end), NULL if absent
+const char* find_text(const char* from, const char* end, const char* text) {
+    size_t length = strlen(text);
+    while (from + length <= end) {
+        from = memchr(from, text[0], (size_t)(end - from));
+        if (from == NULL || from + length > end) return NULL;
+        if (memcmp(from, text, length) == 0) return from;
+        from++;
+    }
+    return NULL;
+}
+
+// Decimal integer at *cursor, bounded by `end` (the mapping is not NUL-terminated)
+int sched_trace_number(const char** cursor, const char* end, int64_t* value) {
+    const char* p = *cursor;
+    int negative = p < end && *p == '-';
+    if (negative) p++;
+    if (p == end || *p < '0' || *p > '9') return 0;
+    int64_t parsed = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (parsed > (INT64_MAX - 9) / 10) return 0;
+        parsed = parsed * 10 + (*p++ - '0');
+    }
+    *value = negative ? -parsed : parsed;
+    *cursor = p;
+    return 1;
+}
+
+// Integer after `key` (e.g. "prev_pid=") in [from, end)
+int sched_trace_field(const char* from, const char* end, const char* key, int64_t* value) {
+    const char* p = find_text(from, end, key);
+    if (p == NULL) return 0;
+    p += strlen(key);
+    return sched_trace_number(&p, end, value);
+}
+
+// Task in the form of older perf versions, "comm:pid [prio]", ending before `to`.
+// *after points behind the closing bracket.
+int sched_trace_task_ref(const char* from, const char* to, int64_t* pid, int64_t* prio, const char** after) {
+    const char* bracket = to;
+    while (bracket > from && bracket[-1] != '[') bracket--;
+    if (bracket - from < 4 || bracket[-2] != ' ') return 0;
+    const char* digits = bracket - 2;
+    while (digits > from && digits[-1] >= '0' && digits[-1] <= '9') digits--;
+    if (digits == bracket - 2 || digits == from || digits[-1] != ':') return 0;
+    const char* p = digits;
+    if (!sched_trace_number(&p, to, pid)) return 0;
+    p = bracket;
+    if (!sched_trace_number(&p, to, prio) || p == to || *p != ']') return 0;
+    *after = p + 1;
+    return 1;
+}
+
+int64_t sched_trace_ticks(const SchedTraceImport* imp, int64_t ns) {
+    return (ns - imp->start + imp->tick / 2) / imp->tick;
+}
+
+void* sched_trace_grow(void* data, size_t* capacity, size_t element_size) {
+    size_t grown = *capacity == 0 ? 1024 : *capacity * 2;
+    void* moved = realloc(data, grown * element_size);
+    if (moved == NULL) arena_out_of_memory(grown * element_size);
+    *capacity = grown;
+    return moved;
+}
+
+// Live task of `tid`, added with `state` since `now` when it has none
+SchedTask* sched_trace_task(SchedTraceImport* imp, int tid, int64_t now, int state) {
+    int index = imp->task_of_tid[tid];
+    if (index >= 0) return &imp->tasks[index];
+    if (imp->free_task >= 0) {
+        index = imp->free_task;
+        imp->free_task = imp->tasks[index].next_free;
+    } else {
+        if (imp->num_tasks == imp->task_capacity) {
+            size_t capacity = (size_t)imp->task_capacity;
+            imp->tasks = sched_trace_grow(imp->tasks, &capacity, sizeof(SchedTask));
+            imp->task_capacity = (int)capacity;
+        }
+        index = imp->num_tasks++;
+    }
+    SchedTask* task = &imp->tasks[index];
+    memset(task, 0, sizeof(*task));
+    task->tid = tid;
+    task->arrival = now;
+    task->since = now;
+    task->state = (int8_t)state;
+    task->ran = state == SCHED_TASK_RUNNING;
+    task->io_head = task->io_tail = SCHED_IO_NONE;
+    imp->task_of_tid[tid] = index;
+    return task;
+}
+
+// End of a blocked interval: one I/O operation at the CPU time used so far
+void sched_trace_unblock(SchedTraceImport* imp, SchedTask* task, int64_t now) {
+    int64_t request = sched_trace_ticks(imp, imp->start + task->cpu);
+    int64_t burst = sched_trace_ticks(imp, now) - sched_trace_ticks(imp, task->since);
+    task->state = SCHED_TASK_READY;
+    task->since = now;
+    if (burst <= 0 || request <= 0) {
+        imp->unresolved_blocks++;
+        return;
+    }
+    if (task->io_tail != SCHED_IO_NONE && imp->io[task->io_tail].op.request_time == request) {
+        imp->io[task->io_tail].op.burst_time += (int)burst;   // Blocked again without a time unit of CPU
+        return;
+    }
+    if (imp->num_io == imp->io_capacity) imp->io = sched_trace_grow(imp->io, &imp->io_capacity, sizeof(SchedIo));
+    if (imp->num_io >= SCHED_IO_NONE) arena_out_of_memory(imp->num_io * sizeof(SchedIo));
+    uint32_t index = (uint32_t)imp->num_io++;
+    imp->io[index].op.request_time = (int)request;
+    imp->io[index].op.burst_time = (int)burst;
+    imp->io[index].next = SCHED_IO_NONE;
+    if (task->io_tail == SCHED_IO_NONE) {
+        task->io_head = index;
+    } else {
+        imp->io[task->io_tail].next = index;
+    }
+    task->io_tail = index;
+}
+
+// The task exited or the trace ended: its process record, if it ever ran
+void sched_trace_finish(SchedTraceImport* imp, SchedTask* task) {
+    if (task->ran) {
+        if (imp->count == imp->record_capacity) {
+            size_t size = (size_t)imp->record_capacity * sizeof(WorkloadRecord);
+            imp->records = arena_grow(imp->arena, imp->records, size, size * 2);
+            imp->record_capacity *= 2;
+        }
+        int64_t burst = sched_trace_ticks(imp, imp->start + task->cpu);
+        WorkloadRecord* r = &imp->records[imp->count++];
+        r->pid = task->tid;
+        r->arrival_time = (int32_t)sched_trace_ticks(imp, task->arrival);
+        r->cpu_burst_time = burst > 0 ? (int32_t)burst : 1;
+        // Nice 0 is the middle, as cfs_weight expects. Kernel priorities 0..139 become -115..24, so
+        // real-time tasks rank ahead of every nice level and each value gets its own priority bucket.
+        r->priority = task->prio - 120 + PRIORITY_LEVELS / 2;
+        r->io_first = task->io_head;
+        r->io_count = 0;
+    }
+    int index = (int)(task - imp->tasks);
+    imp->task_of_tid[task->tid] = -1;
+    task->next_free = imp->free_task;
+    imp->free_task = index;
+}
+
+// One line of the trace; lines without a sched_switch or sched_wakeup event are skipped.
+// Returns 0, or -1 for a malformed event.
+int sched_trace_line(SchedTraceImport* imp, const char* line, const char* end) {
+    // "... [CPU] ... SECONDS.FRACTION: sched_EVENT: " (ftrace) or ": sched:sched_EVENT: " (perf)
+    const char* event = line;
+    const char* colon;
+    while (1) {
+        colon = find_text(event, end, ": sched");
+        if (colon == NULL) return 0;
+        event = colon + 7;
+        if (colon > line && colon[-1] >= '0' && colon[-1] <= '9') break;
+    }
+    if (end - event >= 7 && memcmp(event, ":sched_", 7) == 0) {
+        event += 7;
+    } else if (event < end && *event == '_') {
+        event += 1;
+    } else {
+        return 0;
+    }
+    int wakeup;
+    const char* payload;
+    if (end - event >= 8 && memcmp(event, "switch: ", 8) == 0) {
+        wakeup = 0;
+        payload = event + 8;
+    } else if (end - event >= 8 && memcmp(event, "wakeup: ", 8) == 0) {
+        wakeup = 1;
+        payload = event + 8;
+    } else if (end - event >= 12 && memcmp(event, "wakeup_new: ", 12) == 0) {
+        wakeup = 1;
+        payload = event + 12;
+    } else {
+        return 0;
+    }
+
+    const char* stamp = colon;
+    while (stamp > line && ((stamp[-1] >= '0' && stamp[-1] <= '9') || stamp[-1] == '.')) stamp--;
+    const char* dot = memchr(stamp, '.', (size_t)(colon - stamp));
+    const char* p = stamp;
+    int64_t seconds, fraction;
+    if (dot == NULL || !sched_trace_number(&p, dot, &seconds) || p != dot) return -1;
+    p = dot + 1;
+    if (!sched_trace_number(&p, colon, &fraction) || p != colon || colon - dot - 1 > 9) return -1;
+    for (int digits = (int)(colon - dot - 1); digits < 9; digits++) fraction *= 10;
+    if (seconds > INT64_MAX / 1000000000 - 1) return -1;
+    int64_t now = seconds * 1000000000 + fraction;
+
+    const char* bracket = stamp;
+    while (bracket > line && bracket[-1] != ']') bracket--;
+    const char* cpu_digits = bracket > line ? bracket - 1 : line;
+    while (cpu_digits > line && cpu_digits[-1] >= '0' && cpu_digits[-1] <= '9') cpu_digits--;
+    int64_t cpu;
+    if (cpu_digits > line && cpu_digits[-1] == '[' && sched_trace_number(&cpu_digits, bracket - 1, &cpu) &&
+        cpu < INT_MAX && cpu > imp->max_cpu) {
+        imp->max_cpu = (int)cpu;
+    }
+
+    int64_t pid, prio, next_pid = 0, next_prio = 0;
+    char prev_state = 'R';
+    if (wakeup) {
+        const char* after;
+        if (!(end - payload >= 5 && memcmp(payload, "comm=", 5) == 0
+                  ? sched_trace_field(payload, end, " pid=", &pid) && sched_trace_field(payload, end, " prio=", &prio)
+                  : sched_trace_task_ref(payload, end, &pid, &prio, &after))) {
+            return -1;
+        }
+    } else {
+        const char* arrow = find_text(payload, end, " ==> ");
+        if (arrow == NULL) return -1;
+        const char* state;
+        const char* after;
+        if (find_text(payload, arrow, "prev_pid=") != NULL) {
+            if (!sched_trace_field(payload, arrow, "prev_pid=", &pid) ||
+                !sched_trace_field(payload, arrow, "prev_prio=", &prio) ||
+                (state = find_text(payload, arrow, "prev_state=")) == NULL ||
+                !sched_trace_field(arrow, end, "next_pid=", &next_pid) ||
+                !sched_trace_field(arrow, end, "next_prio=", &next_prio)) {
+                return -1;
+            }
+            state += 11;
+        } else {
+            if (!sched_trace_task_ref(payload, arrow, &pid, &prio, &state) ||
+                !sched_trace_task_ref(arrow + 5, end, &next_pid, &next_prio, &after)) {
+                return -1;
+            }
+            while (state < arrow && *state == ' ') state++;
+        }
+        if (state < end) prev_state = *state;
+    }
+    if (pid < 0 || pid >= SCHED_TRACE_MAX_TID || next_pid < 0 || next_pid >= SCHED_TRACE_MAX_TID) return -1;
+
+    if (imp->start < 0) imp->start = imp->last = now;
+    if (now < imp->last) now = imp->last;     // Per-CPU buffers may be merged slightly out of order
+    imp->last = now;
+    imp->events++;
+
+    if (wakeup) {
+        if (pid == 0) return 0;
+        SchedTask* task = sched_trace_task(imp, (int)pid, now, SCHED_TASK_READY);
+        if (task->state == SCHED_TASK_BLOCKED) sched_trace_unblock(imp, task, now);
+        task->prio = (int32_t)prio;
+        return 0;
+    }
+    if (pid > 0) {
+        // Running since the start of the trace if this is its first event
+        SchedTask* task = sched_trace_task(imp, (int)pid, imp->start, SCHED_TASK_RUNNING);
+        if (task->state == SCHED_TASK_RUNNING) task->cpu += now - task->since;
+        task->prio = (int32_t)prio;
+        task->since = now;
+        if (prev_state == 'R') {
+            task->state = SCHED_TASK_READY;
+        } else if (prev_state == 'X' || prev_state == 'Z') {
+            sched_trace_finish(imp, task);
+        } else {
+            task->state = SCHED_TASK_BLOCKED;
+        }
+    }
+    if (next_pid > 0) {
+        SchedTask* task = sched_trace_task(imp, (int)next_pid, now, SCHED_TASK_READY);
+        if (task->state == SCHED_TASK_BLOCKED) sched_trace_unblock(imp, task, now);  // Missed wakeup
+        task->prio = (int32_t)next_prio;
+        task->state = SCHED_TASK_RUNNING;
+        task->since = now;
+        task->ran = 1;
+    }
+    return 0;
+}
+
+// Import a scheduler trace with `tick_us` microseconds per time unit. Returns 0 on success.
+int workload_import_sched_trace(Workload* workload, const char* path, int tick_us) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        fprintf(stderr, "%s is empty\n", path);
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    char* base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "Cannot map %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    madvise(base, size, MADV_SEQUENTIAL);
+
+    workload_free(workload);
+    arena_init(&workload->arena, ARENA_DEFAULT_BLOCK);
+    SchedTraceImport imp;
+    memset(&imp, 0, sizeof(imp));
+    imp.tick = (int64_t)tick_us * 1000;
+    imp.start = -1;
+    imp.free_task = -1;
+    imp.max_cpu = -1;
+    imp.arena = &workload->arena;
+    imp.record_capacity = 1024;
+    imp.records = arena_alloc(&workload->arena, (size_t)imp.record_capacity * sizeof(WorkloadRecord));
+    imp.task_of_tid = malloc((size_t)SCHED_TRACE_MAX_TID * sizeof(int));
+    if (imp.task_of_tid == NULL) arena_out_of_memory((size_t)SCHED_TRACE_MAX_TID * sizeof(int));
+    memset(imp.task_of_tid, 0xff, (size_t)SCHED_TRACE_MAX_TID * sizeof(int));
+
+    const char* end = base + size;
+    const char* cursor = base;
+    size_t dropped = 0;
+    long long line_no = 0;
+    int error = 0;
+    while (cursor < end) {
+        const char* newline = memchr(cursor, '\n', (size_t)(end - cursor));
+        const char* line_end = newline != NULL ? newline : end;
+        line_no++;
+        if (sched_trace_line(&imp, cursor, line_end) != 0) {
+            fprintf(stderr, "%s:%lld: malformed sched_switch or sched_wakeup event\n", path, line_no);
+            error = 1;
+            break;
+        }
+        cursor = newline != NULL ? newline + 1 : end;
+        if ((size_t)(cursor - base) - dropped >= SCHED_TRACE_DROP_BYTES) {
+            madvise(base + dropped, SCHED_TRACE_DROP_BYTES, MADV_DONTNEED);
+            dropped += SCHED_TRACE_DROP_BYTES;
+        }
+    }
+    munmap(base, size);
+
+    if (!error && imp.events == 0) {
+        fprintf(stderr, "%s has no sched_switch or sched_wakeup events\n", path);
+        error = 1;
+    }
+    if (!error && sched_trace_ticks(&imp, imp.last) > INT_MAX) {
+        fprintf(stderr, "%s spans %.1f s, more than %d time units of %d us; use a larger --sched-tick\n", path,
+                (double)(imp.last - imp.start) / 1e9, INT_MAX, tick_us);
+        error = 1;
+    }
+    if (!error) {
+        // Tasks still alive at the end of the trace; a final block is not an I/O operation
+        for (int i = 0; i < imp.num_tasks; i++) {
+            SchedTask* task = &imp.tasks[i];
+            if (imp.task_of_tid[task->tid] != i) continue;
+            if (task->state == SCHED_TASK_RUNNING) task->cpu += imp.last - task->since;
+            sched_trace_finish(&imp, task);
+        }
+
+        // Each record's I/O operations, in a contiguous table; those at or after the end of its
+        // CPU burst (a block it never woke up from in time) are dropped
+        IOOperation* io_operations = arena_alloc(&workload->arena, (imp.num_io + 1) * sizeof(IOOperation));
+        size_t num_io = 0;
+        for (int i = 0; i < imp.count; i++) {
+            WorkloadRecord* r = &imp.records[i];
+            uint32_t op = r->io_first;
+            r->io_first = (uint32_t)num_io;
+            for (; op != SCHED_IO_NONE && imp.io[op].op.request_time < r->cpu_burst_time; op = imp.io[op].next) {
+                io_operations[num_io++] = imp.io[op].op;
+                r->io_count++;
+            }
+        }
+        workload->records = imp.records;
+        workload->io_operations = io_operations;
+        workload->count = imp.count;
+        workload->num_io_operations = num_io;
+        workload_order_by_arrival(workload);
+        fprintf(stderr, "Scheduler trace: %d tasks, %zu I/O operations, %.3f s in %d us time units, %d CPUs",
+                imp.count, num_io, (double)(imp.last - imp.start) / 1e9, tick_us, imp.max_cpu + 1);
+        if (imp.unresolved_blocks > 0) {
+            fprintf(stderr, "; %llu blocks below one time unit ignored", (unsigned long long)imp.unresolved_blocks);
+        }
+        fprintf(stderr, "\n");
+    }
+
+    free(imp.task_of_tid);
+    free(imp.tasks);
+    free(imp.io);
+    if (error) {
+        workload_free(workload);
+        return -1;
+    }
+    return 0;
+}
+
+// Trace output
+// Events are encoded into a fixed buffer that is written with one write(2) each time it
+// fills, so a trace of any length needs constant memory and few system calls.
+#define TRACE_BUFFER_SIZE (256 * 1024)
+#define TRACE_RECORD_MAX 256    // Upper bound of one encoded event in any format
+
+typedef struct {
+    int fd;
+    int failed;
+    size_t used;
+    char buffer[TRACE_BUFFER_SIZE];
+} TraceWriter;
+
+int trace_writer_flush(TraceWriter* writer) {
+    size_t done = 0;
+    while (done < writer->used && !writer->failed) {
+        ssize_t written = write(writer->fd, writer->buffer + done, writer->used - done);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            writer->failed = 1;
+        } else {
+            done += (size_t)written;
+        }
+    }
+    writer->used = 0;
+    return writer->failed ? -1 : 0;
+}
+
+// Room for at least TRACE_RECORD_MAX bytes; the caller advances writer->used
+SIM_INLINE char* trace_writer_reserve(TraceWriter* writer) {
+    if (writer->used + TRACE_RECORD_MAX > TRACE_BUFFER_SIZE) trace_writer_flush(writer);
+    return writer->buffer + writer->used;
+}
+
+void trace_writer_append(TraceWriter* writer, const char* text) {
+    size_t length = strlen(text);
+    if (writer->used + length > TRACE_BUFFER_SIZE) trace_writer_flush(writer);
+    memcpy(writer->buffer + writer->used, text, length);
+    writer->used += length;
+}
+
+// Flush and close; returns 0 if every write succeeded
+int trace_writer_close(TraceWriter* writer) {
+    int status = trace_writer_flush(writer);
+    if (close(writer->fd) != 0) status = -1;
+    return status;
+}
+
+// Binary trace: TRACE_MAGIC, then one record per event
+//   tag       event type in bits 0-2; TRACE_TAG_CONTINUES marks a CPU or overhead slice starting
+//             where the previous one ended, whose start is then left out
+//   start     zigzag varint, delta from the previous record's start
+//   duration  varint, end - start
+//   pid       varint
+//   arg       zigzag varint, TRACE_PREEMPT only
+//   cpu       varint, only if the tag has TRACE_TAG_CPU (CPU 0 is left out)
+#define TRACE_MAGIC "CPUSTRC1"
+#define TRACE_TAG_CONTINUES 0x08
+#define TRACE_TAG_CPU 0x10
+
+typedef struct {
+    TraceSink base;
+    int64_t last_start;
+    int64_t last_slice_end;
+    TraceWriter writer;
+} BinaryTraceSink;
+
+SIM_INLINE char* trace_put_varint(char* out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = (char)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (char)value;
+    return out;
+}
+
+SIM_INLINE uint64_t trace_zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+void binary_trace_emit(TraceSink* base, const TraceEvent* event) {
+    BinaryTraceSink* sink = (BinaryTraceSink*)base;
+    char* start = trace_writer_reserve(&sink->writer);
+    char* out = start;
+    int tag = event->type;
+
+    if (event->type == TRACE_CPU_SLICE || event->type == TRACE_OVERHEAD) {
+        if (event->start == sink->last_slice_end) tag |= TRACE_TAG_CONTINUES;
+        sink->last_slice_end = event->end;
+    }
+    if (event->cpu != 0) tag |= TRACE_TAG_CPU;
+    *out++ = (char)tag;
+    if (!(tag & TRACE_TAG_CONTINUES)) {
+        out = trace_put_varint(out, trace_zigzag(event->start - sink->last_start));
+    }
+    out = trace_put_varint(out, (uint64_t)(event->end - event->start));
+    out = trace_put_varint(out, (uint64_t)(uint32_t)event->pid);
+    if (event->type == TRACE_PREEMPT) {
+        out = trace_put_varint(out, trace_zigzag(event->arg));
+    }
+    if (tag & TRACE_TAG_CPU) {
+        out = trace_put_varint(out, (uint64_t)(uint32_t)event->cpu);
+    }
+    sink->last_start = event->start;
+    sink->writer.used += (size_t)(out - start);
+}
+
+int binary_trace_finish(TraceSink* base) {
+    BinaryTraceSink* sink = (BinaryTraceSink*)base;
+    int status = trace_writer_close(&sink->writer);
+    free(sink);
+    return status;
+}
+
+// Chrome Trace Event JSON. Time units are shown as microseconds.
+//   pid 1 "CPU"       : one thread per CPU (tid = CPU + 1) with its Gantt chart, overhead slices and
+//                       preemption markers
+//   pid 2 "Processes" : one thread per process with its Running, Ready and I/O intervals
+typedef struct {
+    TraceSink base;
+    CpuMask named;          // CPUs whose thread_name metadata has been written
+    TraceWriter writer;
+} ChromeTraceSink;
+
+void chrome_trace_emit(TraceSink* base, const TraceEvent* event) {
+    ChromeTraceSink* sink = (ChromeTraceSink*)base;
+    char* out = trace_writer_reserve(&sink->writer);
+    const char* separator = ",\n";   // The header always holds the metadata events
+    int length = 0;
+    long long start = (long long)event->start;
+    long long duration = (long long)(event->end - event->start);
+    int tid = event->cpu + 1;
+
+    if (event->type != TRACE_IO && event->type != TRACE_READY && !cpu_mask_test(&sink->named, event->cpu)) {
+        cpu_mask_set(&sink->named, event->cpu);
+        length = snprintf(out, TRACE_RECORD_MAX,
+                          "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"CPU %d\"}}",
+                          separator, tid, event->cpu);
+        sink->writer.used += (size_t)length;
+        out = trace_writer_reserve(&sink->writer);
+    }
+
+    switch (event->type) {
+        case TRACE_CPU_SLICE:
+            if (event->pid == 0) {
+                length = snprintf(out, TRACE_RECORD_MAX,
+                                  "%s{\"name\":\"Idle\",\"cat\":\"cpu\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":%d}",
+                                  separator, start, duration, tid);
+            } else {
+                length = snprintf(out, TRACE_RECORD_MAX,
+                                  "%s{\"name\":\"P%d\",\"cat\":\"cpu\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":%d},\n"
+                                  "{\"name\":\"Running\",\"cat\":\"cpu\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":2,\"tid\":%d}",
+                                  separator, event->pid, start, duration, tid,
+                                  start, duration, event->pid);
+            }
+            break;
+        case TRACE_OVERHEAD:
+            length = snprintf(out, TRACE_RECORD_MAX,
+                              "%s{\"name\":\"Switch to P%d\",\"cat\":\"overhead\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":%d}",
+                              separator, event->pid, start, duration, tid);
+            break;
+        case TRACE_IO:
+            length = snprintf(out, TRACE_RECORD_MAX,
+                              "%s{\"name\":\"I/O\",\"cat\":\"io\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":2,\"tid\":%d}",
+                              separator, start, duration, event->pid);
+            break;
+        case TRACE_READY:
+            length = snprintf(out, TRACE_RECORD_MAX,
+                              "%s{\"name\":\"Ready\",\"cat\":\"queue\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":2,\"tid\":%d}",
+                              separator, start, duration, event->pid);
+            break;
+        case TRACE_PREEMPT:
+            length = snprintf(out, TRACE_RECORD_MAX,
+                              "%s{\"name\":\"%s P%d\",\"cat\":\"sched\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%lld,\"pid\":1,\"tid\":%d,"
+                              "\"args\":{\"by\":%d}}",
+                              separator, event->arg == 0 ? "Quantum expired" : "Preempted", event->pid,
+                              start, tid, event->arg);
+            break;
+    }
+    sink->writer.used += (size_t)length;
+}
+
+int chrome_trace_finish(TraceSink* base) {
+    ChromeTraceSink* sink = (ChromeTraceSink*)base;
+    trace_writer_append(&sink->writer, "\n]}\n");
+    int status = trace_writer_close(&sink->writer);
+    free(sink);
+    return status;
+}
+
+// Open a trace file; returns NULL (after reporting) on failure
+TraceSink* trace_sink_open(const char* path, enum TraceFormat format) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot create trace file %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    if (format == TRACE_FORMAT_BINARY) {
+        BinaryTraceSink* sink = malloc(sizeof(BinaryTraceSink));
+        if (sink == NULL) arena_out_of_memory(sizeof(BinaryTraceSink));
+        sink->base.emit = binary_trace_emit;
+        sink->base.finish = binary_trace_finish;
+        sink->last_start = 0;
+        sink->last_slice_end = -1;
+        sink->writer.fd = fd;
+        sink->writer.failed = 0;
+        sink->writer.used = 0;
+        trace_writer_append(&sink->writer, TRACE_MAGIC);
+        return &sink->base;
+    }
+
+    ChromeTraceSink* sink = malloc(sizeof(ChromeTraceSink));
+    if (sink == NULL) arena_out_of_memory(sizeof(ChromeTraceSink));
+    sink->base.emit = chrome_trace_emit;
+    sink->base.finish = chrome_trace_finish;
+    memset(&sink->named, 0, sizeof(sink->named));
+    cpu_mask_set(&sink->named, 0);     // Named in the header
+    sink->writer.fd = fd;
+    sink->writer.failed = 0;
+    sink->writer.used = 0;
+    trace_writer_append(&sink->writer,
+                        "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+                        "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"CPU\"}},\n"
+                        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU 0\"}},\n"
+                        "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"Processes\"}}");
+    return &sink->base;
+}
+
+// Decode a varint at *cursor; returns 0 if the record runs past `end`
+int trace_get_varint(const unsigned char** cursor, const unsigned char* end, uint64_t* value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && *cursor < end; shift += 7) {
+        unsigned char byte = *(*cursor)++;
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Replay a binary trace into another sink (e.g. convert it to Chrome JSON). Returns 0 on success.
+int trace_replay_binary(const char* path, TraceSink* sink) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open trace file %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TRACE_MAGIC) - 1) {
+        fprintf(stderr, "Trace file %s is too small\n", path);
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    const unsigned char* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "Cannot map trace file %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    madvise((void*)data, size, MADV_SEQUENTIAL);
+
+    int status = 0;
+    if (memcmp(data, TRACE_MAGIC, sizeof(TRACE_MAGIC) - 1) != 0) {
+        fprintf(stderr, "%s is not a binary trace file\n", path);
+        status = -1;
+    }
+
+    const unsigned char* cursor = data + sizeof(TRACE_MAGIC) - 1;
+    const unsigned char* end = data + size;
+    int64_t last_start = 0;
+    int64_t last_slice_end = -1;
+    while (status == 0 && cursor < end) {
+        int tag = *cursor++;
+        uint64_t delta = 0, duration, pid, arg = 0, cpu = 0;
+        TraceEvent event;
+        event.type = tag & 0x07;
+        if (event.type > TRACE_OVERHEAD ||
+            (!(tag & TRACE_TAG_CONTINUES) && !trace_get_varint(&cursor, end, &delta)) ||
+            !trace_get_varint(&cursor, end, &duration) ||
+            !trace_get_varint(&cursor, end, &pid) ||
+            (event.type == TRACE_PREEMPT && !trace_get_varint(&cursor, end, &arg)) ||
+            ((tag & TRACE_TAG_CPU) && (!trace_get_varint(&cursor, end, &cpu) || cpu >= MAX_CPUS))) {
+            fprintf(stderr, "Trace file %s is truncated or corrupt\n", path);
+            status = -1;
+            break;
+        }
+
+        int64_t start = (tag & TRACE_TAG_CONTINUES) ? last_slice_end
+                                                    : last_start + (int64_t)((delta >> 1) ^ -(delta & 1));
+        event.start = start;
+        event.end = start + (int64_t)duration;
+        event.pid = (int)pid;
+        event.arg = (int)((arg >> 1) ^ -(arg & 1));
+        event.cpu = (int)cpu;
+        if (event.type == TRACE_CPU_SLICE || event.type == TRACE_OVERHEAD) last_slice_end = event.end;
+        last_start = start;
+        sink->emit(sink, &event);
+    }
+
+    munmap((void*)data, size);
+    return status;
+}
+
+void Create_Process(Workload* workload) {
+    int num_processes;
+    printf("Enter number of processes (e.g., 5): ");
+    if (scanf("%d", &num_processes) != 1 || num_processes <= 0) {
+        printf("Invalid number of processes. Setting to default 5.\n");
+        num_processes = 5;
+        while (getchar() != '\n');
+    }
+
+    // Printed so the workload can be regenerated with --random N --seed SEED
+    uint64_t seed = (uint64_t)time(NULL);
+    generate_random_workload(workload, num_processes, seed);
+
+    printf("\n--- Generating Random Processes (seed %llu) ---\n", (unsigned long long)seed);
+    printf("PID | Arrival | CPU Burst | Priority | I/O Operations\n");
+    printf("----|---------|-----------|----------|---------------\n");
+
+    for (int i = 0; i < num_processes; i++) {
+        const WorkloadRecord* r = &workload->records[i];
+        const IOOperation* io = &workload->io_operations[r->io_first];
+
+        printf("%3d | %7d | %9d | %8d | ", r->pid, r->arrival_time, r->cpu_burst_time, r->priority);
+        
+        if(r->io_count == 0){
+            printf("No I/O Operations");
+        }
+
+        for (uint32_t j = 0; j < r->io_count; j++) {
+            printf("I/O.%u - [req: %d, burst: %d] ", j+1, io[j].request_time, io[j].burst_time);
+        }
+        printf("\n");
+    }
+    
+    printf("\n--- Processes Created Successfully ---\n");
+}
+
+// Open-system streaming (--stream): processes are taken from a source one at a time, when the
+// one before arrives, and run in slots of a reserved pool that are reused as soon as they
+// complete. Memory follows the processes in the system, not all that ever arrived.
+#define STREAM_MAX_LIVE (1 << 22)   // Processes in the system at once
+#define STREAM_QUEUE_HINT 1024      // Initial ready queue capacity; queues grow on demand
+
+typedef struct {
+    // Text workload read line by line (processes in arrival order), or the generator
+    FILE* file;
+    const char* path;
+    char* line;
+    size_t line_capacity;
+    int line_no;
+    const GeneratorConfig* generator;
+    Xoshiro256 rng;
+    Xoshiro256 io_rng;
+    int next;                   // Index of the next generated process
+    int64_t chunk_start;        // Arrival time the current chunk's times count from
+    int64_t chunk_last;         // Arrival of the chunk's latest process, relative to the chunk
+    double clock;
+    int burst_left;
+
+    int64_t last_arrival;
+    int64_t horizon;            // No process arrives at or after this time
+    int exhausted;
+} StreamSource;
+
+// Completions and CPU time of one window interval
+typedef struct {
+    uint64_t completed;
+    LatencyDistribution waiting;    // Of the processes completed in the interval
+    int64_t busy;                   // CPU time spent running processes
+    int64_t length;
+} StreamWindow;
+
+struct StreamState {
+    StreamSource source;
+    Process* pool;              // STREAM_MAX_LIVE slots, the run's processes
+    IOOperation* io;            // MAX_IO_OPERATIONS per slot
+    CfsEntity* cfs_entities;    // Per slot, then the sentinel
+    ProcessTimes* times;        // Per slot
+    int64_t* off_cpu_since;     // Per slot
+    int* tickets;               // Per slot (lottery and stride)
+    int64_t* stride_passes;     // Per slot
+    size_t reserved;            // Bytes of the pool mapping
+    int free_slot;              // Completed slots, linked through event_next (-1: none)
+    int used_slots;             // Slots from here on were never used
+    int live;                   // Processes arrived or about to, not completed
+    int peak_live;
+    int64_t admitted;
+    int overflow;               // Stopped taking processes: the pool was full
+    Process departed;           // Stands for completed processes in Cpu.last_dispatched
+
+    StreamWindow* windows;      // The intervals of the reporting span, a ring
+    int num_windows;
+    int current_window;
+};
+
+// Open `path` ("-": standard input), or generate from `generator` if `path` is NULL.
+// Returns 0 on success.
+int stream_source_open(StreamSource* source, const char* path, const GeneratorConfig* generator, int64_t horizon) {
+    memset(source, 0, sizeof(*source));
+    source->horizon = horizon;
+    if (path == NULL) {
+        source->generator = generator;
+        return 0;
+    }
+    source->path = strcmp(path, "-") == 0 ? "stdin" : path;
+    source->file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (source->file == NULL) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+void stream_source_close(StreamSource* source) {
+    if (source->file != NULL && source->file != stdin) fclose(source->file);
+    free(source->line);
+    source->file = NULL;
+    source->line = NULL;
+}
+
+// Next process in arrival order into `r` and `io` (room for MAX_IO_OPERATIONS), its arrival
+// time into `arrival`. Returns 0 once the source is exhausted. Generated processes are those
+// of the batch generator with the same seed, in the same order.
+int stream_source_next(StreamSource* source, WorkloadRecord* r, IOOperation* io, int64_t* arrival) {
+    if (source->exhausted) return 0;
+    if (source->generator != NULL) {
+        const GeneratorConfig* config = source->generator;
+        if (source->next == INT_MAX) {
+            source->exhausted = 1;
+            return 0;
+        }
+        int first = source->next - source->next % GENERATOR_CHUNK;
+        if (source->next == first) {
+            uint64_t chunk = (uint64_t)(first / GENERATOR_CHUNK);
+            rng_seed(&source->io_rng, config->seed, chunk * 2 + STREAM_IO_COUNT);
+            rng_seed(&source->rng, config->seed, chunk * 2 + STREAM_PROCESS);
+            source->chunk_start += source->chunk_last;
+            source->chunk_last = 0;
+            source->clock = 0;
+            source->burst_left = 0;
+        }
+        generator_draw(config, &source->rng, &source->io_rng, source->next, first, &source->clock,
+                       &source->burst_left, r, io);
+        source->next++;
+        source->chunk_last = llround(source->clock);
+        *arrival = source->chunk_start + source->chunk_last;
+        if (*arrival >= source->horizon) {
+            source->exhausted = 1;
+            return 0;
+        }
+        return 1;
+    }
+
+    ssize_t length;
+    while ((length = getline(&source->line, &source->line_capacity, source->file)) != -1) {
+        source->line_no++;
+        char* cursor = workload_line_data(source->line, source->line_no);
+        if (cursor == NULL) continue;
+        if (parse_workload_line(cursor, source->path, source->line_no, r, arrival, io, MAX_IO_OPERATIONS, NULL) != 0) {
+            break;
+        }
+        if (*arrival < source->last_arrival) {
+            fprintf(stderr, "%s:%d: streamed processes must come in arrival order\n", source->path, source->line_no);
+            break;
+        }
+        if (*arrival >= source->horizon) break;
+        source->last_arrival = *arrival;
+        return 1;
+    }
+    source->exhausted = 1;
+    return 0;
+}
+
+// Reserve the slot pool; pages are only committed as slots get used. Returns 0 on success.
+int stream_init(StreamState* stream, int window_span) {
+    memset(stream, 0, sizeof(*stream));
+    size_t process_bytes = (size_t)STREAM_MAX_LIVE * sizeof(Process);
+    size_t io_bytes = (size_t)STREAM_MAX_LIVE * MAX_IO_OPERATIONS * sizeof(IOOperation);
+    size_t cfs_bytes = (size_t)(STREAM_MAX_LIVE + 1) * sizeof(CfsEntity);
+    size_t times_bytes = (size_t)STREAM_MAX_LIVE * sizeof(ProcessTimes);
+    size_t off_cpu_bytes = (size_t)STREAM_MAX_LIVE * sizeof(int64_t);
+    size_t pass_bytes = (size_t)STREAM_MAX_LIVE * sizeof(int64_t);
+    size_t ticket_bytes = (size_t)STREAM_MAX_LIVE * sizeof(int);
+    stream->reserved = process_bytes + io_bytes + cfs_bytes + times_bytes + off_cpu_bytes + pass_bytes + ticket_bytes;
+    char* base = mmap(NULL, stream->reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                      -1, 0);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "Cannot reserve %zu bytes for the stream: %s\n", stream->reserved, strerror(errno));
+        return -1;
+    }
+    stream->pool = (Process*)base;
+    stream->io = (IOOperation*)(base + process_bytes);
+    stream->cfs_entities = (CfsEntity*)(base + process_bytes + io_bytes);
+    char* cursor = base + process_bytes + io_bytes + cfs_bytes;
+    stream->times = (ProcessTimes*)cursor;
+    stream->off_cpu_since = (int64_t*)(cursor + times_bytes);
+    stream->stride_passes = (int64_t*)(cursor + times_bytes + off_cpu_bytes);
+    stream->tickets = (int*)(cursor + times_bytes + off_cpu_bytes + pass_bytes);
+    stream->free_slot = -1;
+    stream->num_windows = window_span;
+    stream->windows = calloc((size_t)window_span, sizeof(StreamWindow));
+    if (stream->windows == NULL) arena_out_of_memory((size_t)window_span * sizeof(StreamWindow));
+    return 0;
+}
+
+void stream_free(StreamState* stream) {
+    if (stream->pool != NULL) munmap(stream->pool, stream->reserved);
+    free(stream->windows);
+    stream_source_close(&stream->source);
+    memset(stream, 0, sizeof(*stream));
+}
+
+// Simulation context utility functions
+// MLFQ: three levels with quanta doubling from the Round Robin quantum
+void policy_defaults(PolicyConfig* policy) {
+    policy->time_quantum = TIME_QUANTUM;
+    policy->mlfq.num_levels = 3;
+    for (int level = 0; level < policy->mlfq.num_levels; level++) policy->mlfq.quanta[level] = TIME_QUANTUM << level;
+    policy->mlfq.boost_period = MLFQ_BOOST_PERIOD;
+    policy->cfs.target_latency = CFS_TARGET_LATENCY;
+    policy->cfs.min_granularity = CFS_MIN_GRANULARITY;
+    policy->share.seed = 1;
+    policy->share.window = SHARE_WINDOW;
+}
+
+void sim_context_init(SimContext* ctx, const Workload* workload) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->workload = workload;
+    heap_init(&ctx->event_wheel.due, compare_event);
+    ctx->machine.num_cpus = 1;     // Ready queues are set up per algorithm and CPU in each run
+    policy_defaults(&ctx->policy);
+    ctx->verbose = 1;
+}
+
+void sim_context_free(SimContext* ctx) {
+    arena_release(&ctx->arena);
+    ctx->processes = NULL;
+    ctx->cpus = NULL;
+    ctx->cfs_entities = NULL;
+    ctx->gantt_chart = NULL;
+}
+
+void Config(SimContext* ctx, const Workload* workload) {
+    printf("\n--- System Configuration ---\n");
+
+    sim_context_free(ctx);
+    sim_context_init(ctx, workload);
+    printf("\n    Ready Queue Configuration\n");
+    printf("    Event Queue Configuration\n");
+    
+    printf("\n--- Configuration Complete ---\n");
+}
+
+// Run state of a process about to arrive at `arrival`
+void process_init(const SimContext* ctx, Process* p, const WorkloadRecord* r, int64_t arrival) {
+    p->pid = r->pid;
+    p->arrival_time = arrival;
+    p->priority = r->priority;
+    p->cpu_burst_time = r->cpu_burst_time;
+    p->remaining_cpu_total = r->cpu_burst_time;
+    p->last_active_time = arrival;
+    ctx->times[p - ctx->processes] = (ProcessTimes){0, -1};
+    p->io_next = (int)r->io_first;
+    p->io_left = (int)r->io_count;
+    p->heap_index = -1;
+    p->cpu = -1;
+    p->mlfq_level = 0;
+    p->event_type = EVENT_NONE;
+    p->event_level = WHEEL_DUE;
+    p->event_time = 0;
+    p->event_next = -1;
+    p->event_prev = -1;
+    if (ctx->phases != NULL) phase_advance(ctx->phases, p, 0);
+}
+
+void reset_processes_for_simulation(SimContext* ctx) {
+    const Workload* workload = ctx->workload;
+    StreamState* stream = ctx->stream;
+    int num_processes = stream != NULL ? 0 : workload->count;  // A stream fills its pool as processes arrive
+    ctx->num_processes = stream != NULL ? STREAM_MAX_LIVE : num_processes;
+
+    // Previous run's storage is released in one shot; size this run's arena up front
+    int num_cpus = ctx->machine.num_cpus;
+    size_t process_bytes = (size_t)num_processes * sizeof(Process);
+    size_t times_bytes = (size_t)num_processes * sizeof(ProcessTimes);
+    size_t queue_bytes = (size_t)(num_processes > 16 ? num_processes : 16) * sizeof(Process*);
+    size_t gantt_capacity_hint = ctx->verbose ? (size_t)num_processes * 4 + 16 : 0;
+    arena_release(&ctx->arena);
+    arena_init(&ctx->arena, arena_class_size(process_bytes) + arena_class_size(times_bytes) +
+                            arena_class_size(queue_bytes) + arena_class_size((size_t)num_cpus * sizeof(Cpu)) +
+                            arena_class_size(gantt_capacity_hint * sizeof(GanttEntry)));
+
+    Process* processes = stream != NULL ? stream->pool : arena_alloc(&ctx->arena, process_bytes);
+    ctx->processes = processes;
+    ctx->times = stream != NULL ? stream->times : arena_alloc(&ctx->arena, times_bytes);
+    ctx->cpus = arena_alloc(&ctx->arena, (size_t)num_cpus * sizeof(Cpu));
+    memset(ctx->cpus, 0, (size_t)num_cpus * sizeof(Cpu));
+    memset(&ctx->dirty, 0, sizeof(ctx->dirty));
+    memset(&ctx->available, 0, sizeof(ctx->available));
+    memset(&ctx->queued, 0, sizeof(ctx->queued));
+    ctx->next_cpu = 0;
+    for (int c = 0; c < num_cpus; c++) {
+        ctx->cpus[c].id = c;
+        cpu_mask_set(&ctx->available, c);
+    }
+    wheel_reset(&ctx->event_wheel, &ctx->arena, processes);
+    ctx->gantt_capacity = (int)gantt_capacity_hint;
+    ctx->gantt_chart = ctx->verbose ? arena_alloc(&ctx->arena, gantt_capacity_hint * sizeof(GanttEntry)) : NULL;
+    // Read only once a process has left a CPU, so it needs no initial values
+    ctx->off_cpu_since = ctx->machine.refill_cost == 0 ? NULL
+                       : stream != NULL                ? stream->off_cpu_since
+                                                       : arena_alloc(&ctx->arena, (size_t)num_processes * sizeof(int64_t));
+
+    // The arrival order comes with the workload, so this is one pass
+    ctx->io_operations = stream != NULL ? stream->io : workload->io_operations;
+    ctx->phases = workload->phases;
+    ctx->realtime = stream != NULL ? NULL : workload->realtime;
+    const int* order = workload->arrival_order;
+    ctx->priorities[0] = num_processes > 0 ? INT_MAX : 0;     // A stream's priorities are not known up front
+    ctx->priorities[1] = num_processes > 0 ? INT_MIN : PRIORITY_LEVELS - 1;
+    for (int i = 0; i < num_processes; i++) {
+        const WorkloadRecord* r = &workload->records[order != NULL ? order[i] : i];
+        process_init(ctx, &processes[i], r, r->arrival_time);
+        if (r->priority < ctx->priorities[0]) ctx->priorities[0] = r->priority;
+        if (r->priority > ctx->priorities[1]) ctx->priorities[1] = r->priority;
+    }
+
+    ctx->gantt_idx = 0;
+}
+
+// Ready queue key of a real-time run: EDF orders by absolute deadline, rate monotonic by
+// period (an aperiodic process by its relative deadline). Processes without one come last.
+// A record's arrival and relative deadline are both at most INT_MAX, so the absolute deadline
+// shifted down by 2^31 fits an int below INT_MAX.
+int realtime_key(const SimContext* ctx, const Process* p, enum SchedulingMode mode) {
+    if (ctx->realtime == NULL) return INT_MAX;
+    const RealtimeRecord* rt = &ctx->realtime[process_record(ctx, p)];
+    if (mode == RM_MODE && rt->period > 0) return rt->period;
+    if (rt->deadline <= 0) return INT_MAX;
+    if (mode == RM_MODE) return rt->deadline;
+    int64_t deadline = p->arrival_time + rt->deadline;
+    return (int)(deadline + INT_MIN);
+}
+
+// Priority fields for a run of `mode`: real-time keys, otherwise the workload's priorities
+void process_set_priorities(SimContext* ctx, enum SchedulingMode mode) {
+    for (int i = 0; i < ctx->num_processes; i++) {
+        Process* p = &ctx->processes[i];
+        p->priority = realtime_mode(mode) ? realtime_key(ctx, p, mode)
+                                          : ctx->workload->records[process_record(ctx, p)].priority;
+    }
+}
+
+SIM_INLINE void trace_emit(SimContext* ctx, int type, int pid, int64_t start, int64_t end, int arg, int cpu) {
+    if (ctx->trace == NULL) return;
+    TraceEvent event = {type, pid, start, end, arg, cpu};
+    ctx->trace->emit(ctx->trace, &event);
+}
+
+// Hand the CPU's open Gantt slice to the in-memory chart (verbose runs) and the trace sink
+void gantt_close_slice(SimContext* ctx, Cpu* cpu) {
+    if (!cpu->has_gantt_pending) return;
+    cpu->has_gantt_pending = 0;
+    GanttEntry* slice = &cpu->gantt_pending;
+
+    if (ctx->verbose) {
+        if (ctx->gantt_idx >= ctx->gantt_capacity) {
+            ctx->gantt_chart = arena_grow(&ctx->arena, ctx->gantt_chart,
+                                          (size_t)ctx->gantt_capacity * sizeof(GanttEntry),
+                                          (size_t)ctx->gantt_capacity * 2 * sizeof(GanttEntry));
+            ctx->gantt_capacity *= 2;
+        }
+        ctx->gantt_chart[ctx->gantt_idx++] = *slice;
+    }
+    trace_emit(ctx, slice->overhead ? TRACE_OVERHEAD : TRACE_CPU_SLICE, slice->pid, slice->start, slice->end, 0,
+               slice->cpu);
+}
+
+void add_gantt_entry(SimContext* ctx, Cpu* cpu, int pid, int64_t start, int64_t end) {
+    GanttEntry* last = &cpu->gantt_pending;
+    if (cpu->has_gantt_pending && last->pid == pid && last->end == start && !last->overhead) {
+        last->end = end;
+        INSTR_COUNT(ctx->metrics.instr.gantt_coalesces);
+    } 
+    else {
+        gantt_close_slice(ctx, cpu);
+        last->pid = pid;
+        last->start = start;
+        last->end = end;
+        last->cpu = cpu->id;
+        last->overhead = 0;
+        cpu->has_gantt_pending = 1;
+    }
+}
+
+// Overhead slice before pid runs; never merged with a neighbour
+void add_gantt_overhead(SimContext* ctx, Cpu* cpu, int pid, int64_t start, int64_t end) {
+    gantt_close_slice(ctx, cpu);
+    GanttEntry* slice = &cpu->gantt_pending;
+    slice->pid = pid;
+    slice->start = start;
+    slice->end = end;
+    slice->cpu = cpu->id;
+    slice->overhead = 1;
+    cpu->has_gantt_pending = 1;
+}
+
+// Metrics utility functions
+SIM_INLINE void stats_add(RunningStats* stats, int64_t value) {
+    stats->count++;
+    stats->sum += value;
+    double delta = (double)value - stats->mean;
+    stats->mean += delta / (double)stats->count;
+    stats->m2 += delta * ((double)value - stats->mean);
+    if (value > stats->max) stats->max = value;
+}
+
+void stats_merge(RunningStats* into, const RunningStats* from) {
+    if (from->count == 0) return;
+    if (into->count == 0) {
+        *into = *from;
+        return;
+    }
+    double count = (double)(into->count + from->count);
+    double delta = from->mean - into->mean;
+    into->m2 += from->m2 + delta * delta * ((double)into->count * (double)from->count / count);
+    into->mean += delta * ((double)from->count / count);
+    into->count += from->count;
+    into->sum += from->sum;
+    if (from->max > into->max) into->max = from->max;
+}
+
+double stats_mean(const RunningStats* stats) {
+    return stats->count > 0 ? (double)stats->sum / (double)stats->count : 0.0;
+}
+
+// Population standard deviation
+double stats_stddev(const RunningStats* stats) {
+    return stats->count > 0 ? sqrt(stats->m2 / (double)stats->count) : 0.0;
+}
+
+SIM_INLINE int histogram_index(uint64_t value) {
+    if (value < (1u << HISTOGRAM_SUB_BITS)) return (int)value;
+    int shift = (63 - __builtin_clzll(value)) - (HISTOGRAM_SUB_BITS - 1);
+    return (shift << (HISTOGRAM_SUB_BITS - 1)) + (int)(value >> shift);
+}
+
+// Largest value that falls into bucket `index`
+int64_t histogram_bucket_limit(int index) {
+    if (index < (1 << HISTOGRAM_SUB_BITS)) return index;
+    int shift = (index >> (HISTOGRAM_SUB_BITS - 1)) - 1;
+    int64_t sub = index - ((int64_t)shift << (HISTOGRAM_SUB_BITS - 1));
+    return (int64_t)(((uint64_t)sub + 1) << shift) - 1;
+}
+
+SIM_INLINE void distribution_add(LatencyDistribution* distribution, int64_t value) {
+    if (value < 0) value = 0;
+    stats_add(&distribution->stats, value);
+    distribution->buckets[histogram_index((uint64_t)value)]++;
+}
+
+// `count` samples of the same value
+void distribution_add_repeated(LatencyDistribution* distribution, int64_t value, uint64_t count) {
+    if (value < 0) value = 0;
+    RunningStats same = {count, value * (int64_t)count, (double)value, 0.0, value};
+    stats_merge(&distribution->stats, &same);
+    distribution->buckets[histogram_index((uint64_t)value)] += count;
+}
+
+void distribution_merge(LatencyDistribution* into, const LatencyDistribution* from) {
+    if (from->stats.count == 0) return;
+    stats_merge(&into->stats, &from->stats);
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        into->buckets[i] += from->buckets[i];
+    }
+}
+
+// Value at quantile q (0 < q <= 1): exact below 2^HISTOGRAM_SUB_BITS, otherwise the upper
+// end of its bucket, never above the observed maximum
+double distribution_quantile(const LatencyDistribution* distribution, double q) {
+    uint64_t count = distribution->stats.count;
+    if (count == 0) return 0.0;
+    uint64_t rank = (uint64_t)ceil(q * (double)count);
+    if (rank < 1) rank = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += distribution->buckets[i];
+        if (seen >= rank) {
+            int64_t limit = histogram_bucket_limit(i);
+            return (double)(limit < distribution->stats.max ? limit : distribution->stats.max);
+        }
+    }
+    return (double)distribution->stats.max;
+}
+
+void metrics_reset(SimMetrics* metrics, int num_processes) {
+    memset(metrics, 0, sizeof(*metrics));
+    metrics->runs = 1;
+    metrics->num_processes = num_processes;
+}
+
+// Called once per process, at its completion
+SIM_INLINE void metrics_record_completion(SimMetrics* metrics, const Process* p, const ProcessTimes* times,
+                                          int64_t completion_time) {
+    metrics->completed_count++;
+    distribution_add(&metrics->waiting, times->waiting_time);
+    distribution_add(&metrics->turnaround, completion_time - p->arrival_time);
+    distribution_add(&metrics->response, times->response_time);
+    metrics->total_busy_time += p->cpu_burst_time;
+    metrics->total_makespan = (double)completion_time;   // Completions arrive in time order
+}
+
+// Deadline accounting of a completed process of a workload with real-time parameters
+void metrics_record_deadline(SimContext* ctx, const Process* p, int64_t completion_time) {
+    const RealtimeRecord* rt = &ctx->realtime[process_record(ctx, p)];
+    if (rt->deadline <= 0) return;
+    int64_t lateness = completion_time - p->arrival_time - rt->deadline;
+    ctx->metrics.deadline_processes++;
+    if (lateness > 0) ctx->metrics.deadline_misses++;
+    distribution_add(&ctx->metrics.lateness, lateness);
+}
+
+// Fraction of the processes with a deadline that missed it
+double metrics_miss_ratio(const SimMetrics* m) {
+    return m->deadline_processes > 0 ? (double)m->deadline_misses / (double)m->deadline_processes : 0.0;
+}
+
+// Share accuracy: CPU time received away from the entitled share, as a fraction of the entitlement
+double metrics_share_error(const SimMetrics* m) {
+    return m->share_entitled > 0 ? m->share_error / m->share_entitled : 0.0;
+}
+
+void heap_counters_merge(HeapCounters* into, const HeapCounters* from) {
+    into->inserts += from->inserts;
+    into->extracts += from->extracts;
+    into->removes += from->removes;
+    into->compares += from->compares;
+}
+
+void instr_merge(InstrCounters* into, const InstrCounters* from) {
+    heap_counters_merge(&into->heap, &from->heap);
+    into->preemptions += from->preemptions;
+    into->quantum_expiries += from->quantum_expiries;
+    into->mlfq_boosts += from->mlfq_boosts;
+    into->io_requests += from->io_requests;
+    into->io_completions += from->io_completions;
+    into->idle_fast_forwards += from->idle_fast_forwards;
+    into->gantt_coalesces += from->gantt_coalesces;
+    into->wheel_cascades += from->wheel_cascades;
+    into->cfs_rotations += from->cfs_rotations;
+    for (int phase = 0; phase < NUM_SIM_PHASES; phase++) {
+        into->phase_ns[phase] += from->phase_ns[phase];
+    }
+}
+
+void metrics_merge(SimMetrics* into, const SimMetrics* from) {
+    into->runs += from->runs;
+    into->num_processes += from->num_processes;
+    into->completed_count += from->completed_count;
+    distribution_merge(&into->waiting, &from->waiting);
+    distribution_merge(&into->turnaround, &from->turnaround);
+    distribution_merge(&into->response, &from->response);
+    into->total_makespan += from->total_makespan;
+    into->total_busy_time += from->total_busy_time;
+    into->context_switches += from->context_switches;
+    into->preemptions += from->preemptions;
+    into->cache_refills += from->cache_refills;
+    into->total_overhead_time += from->total_overhead_time;
+    into->deadline_processes += from->deadline_processes;
+    into->deadline_misses += from->deadline_misses;
+    distribution_merge(&into->lateness, &from->lateness);
+    into->share_windows += from->share_windows;
+    into->share_entitled += from->share_entitled;
+    into->share_error += from->share_error;
+    distribution_merge(&into->share_deviation, &from->share_deviation);
+    if (from->num_cpus > into->num_cpus) into->num_cpus = from->num_cpus;
+    into->migrations += from->migrations;
+    into->steals += from->steals;
+    into->total_imbalance += from->total_imbalance;
+    into->events += from->events;
+    into->dispatches += from->dispatches;
+    instr_merge(&into->instr, &from->instr);
+    if (from->peak_memory > into->peak_memory) into->peak_memory = from->peak_memory;
+}
+
+// Phase timing: PHASE_START() opens the first phase, PHASE_END(phase) charges the time since
+// the previous mark to `phase`
+#if SIM_INSTRUMENT >= 2
+SIM_INLINE uint64_t instr_now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+#define PHASE_START() (ctx->phase_mark_ns = instr_now_ns())
+#define PHASE_END(phase)                                                         \
+    do {                                                                         \
+        uint64_t phase_now_ns = instr_now_ns();                                  \
+        ctx->metrics.instr.phase_ns[phase] += phase_now_ns - ctx->phase_mark_ns; \
+        ctx->phase_mark_ns = phase_now_ns;                                       \
+    } while (0)
+#else
+#define PHASE_START() ((void)0)
+#define PHASE_END(phase) ((void)0)
+#endif
+
+void print_instr_counters(const InstrCounters* instr) {
+#if SIM_INSTRUMENT
+    printf("\n--- Engine Counters ---\n");
+    printf("Heap: %llu inserts, %llu extracts, %llu removes, %llu comparator calls\n",
+           (unsigned long long)instr->heap.inserts, (unsigned long long)instr->heap.extracts,
+           (unsigned long long)instr->heap.removes, (unsigned long long)instr->heap.compares);
+    printf("Preemptions: %llu, quantum expiries: %llu, MLFQ boosts: %llu\n",
+           (unsigned long long)instr->preemptions, (unsigned long long)instr->quantum_expiries,
+           (unsigned long long)instr->mlfq_boosts);
+    printf("I/O: %llu requests, %llu completions\n",
+           (unsigned long long)instr->io_requests, (unsigned long long)instr->io_completions);
+    printf("Idle fast-forwards: %llu, Gantt coalesces: %llu, timing wheel cascades: %llu, CFS tree rotations: %llu\n",
+           (unsigned long long)instr->idle_fast_forwards, (unsigned long long)instr->gantt_coalesces,
+           (unsigned long long)instr->wheel_cascades, (unsigned long long)instr->cfs_rotations);
+#if SIM_INSTRUMENT >= 2
+    printf("Phase time (ms):");
+    for (int phase = 0; phase < NUM_SIM_PHASES; phase++) {
+        printf(" %s %.3f", sim_phase_names[phase], instr->phase_ns[phase] / 1e6);
+    }
+    printf("\n");
+#endif
+#else
+    (void)instr;
+#endif
+}
+
+void print_distribution_row(const char* name, const LatencyDistribution* distribution) {
+    printf("%-10s | %9.2f | %9.2f | %7.0f | %7.0f | %7.0f | %7lld\n", name,
+           stats_mean(&distribution->stats), stats_stddev(&distribution->stats),
+           distribution_quantile(distribution, 0.50), distribution_quantile(distribution, 0.95),
+           distribution_quantile(distribution, 0.99), (long long)distribution->stats.max);
+}
+
+// Per-CPU totals of a finished run into its metrics
+void metrics_record_cpus(SimContext* ctx) {
+    SimMetrics* metrics = &ctx->metrics;
+    int num_cpus = ctx->machine.num_cpus;
+    int64_t total_busy = 0, max_busy = 0;
+    metrics->num_cpus = num_cpus;
+    for (int c = 0; c < num_cpus; c++) {
+        const Cpu* cpu = &ctx->cpus[c];
+        metrics->migrations += cpu->migrations;
+        metrics->steals += cpu->steals;
+        metrics->total_overhead_time += cpu->overhead_time;
+        total_busy += cpu->busy_time;
+        if (cpu->busy_time > max_busy) max_busy = cpu->busy_time;
+    }
+    double mean_busy = (double)total_busy / num_cpus;
+    metrics->total_imbalance = mean_busy > 0 ? max_busy / mean_busy - 1.0 : 0.0;
+}
+
+// Gantt slices of one CPU (all slices with `cpu` -1), GANTT_ENTRIES_PER_LINE slices per line
+void print_gantt_chart(const SimContext* ctx, int cpu) {
+    printf("|");
+    int printed = 0;
+    for (int i = 0; i < ctx->gantt_idx; i++) {
+        GanttEntry* entry = &ctx->gantt_chart[i];
+        if (entry->start < entry->end && (cpu < 0 || entry->cpu == cpu)) {
+            if (printed > 0 && printed % GANTT_ENTRIES_PER_LINE == 0) printf("\n|");
+            if (entry->overhead) {
+                printf(" ovh (%lld-%lld) |", (long long)entry->start, (long long)entry->end);
+            } else {
+                printf(" P%d (%lld-%lld) |", entry->pid, (long long)entry->start, (long long)entry->end);
+            }
+            printed++;
+        }
+    }
+    printf("\n");
+}
+
+void Evaluation(SimContext* ctx, const char* algo_name) {
+    SimMetrics* metrics = &ctx->metrics;
+    int num_cpus = ctx->machine.num_cpus;
+    size_t workload_bytes = workload_memory(ctx->workload);
+    metrics->peak_memory = workload_bytes + ctx->arena.peak_reserved;
+    if (!ctx->verbose) return;
+
+    printf("\n--- Evaluation for %s ---\n", algo_name);
+
+    printf("\nGantt Chart:\n");
+    if (num_cpus == 1) {
+        print_gantt_chart(ctx, -1);
+    } else {
+        for (int c = 0; c < num_cpus; c++) {
+            printf("CPU %d:\n", c);
+            print_gantt_chart(ctx, c);
+        }
+    }
+
+    printf("\nProcess Details:\n");
+    printf("PID | Arrival | Completion | Turnaround | Waiting | Response\n");
+    printf("----|---------|------------|------------|---------|---------\n");
+
+    // processes[] is in arrival order; report in workload order
+    int* by_record = arena_alloc(&ctx->arena, (size_t)ctx->num_processes * sizeof(int));
+    for (int i = 0; i < ctx->num_processes; i++) {
+        by_record[process_record(ctx, &ctx->processes[i])] = i;
+    }
+    for (int i = 0; i < ctx->num_processes; i++) {
+        Process* p = &ctx->processes[by_record[i]];
+        const ProcessTimes* times = &ctx->times[by_record[i]];
+        if (p->remaining_cpu_total == 0 && times->response_time >= 0) {     // Completed
+            printf("%3d | %7lld | %10lld | %10lld | %7lld | %8lld\n",
+                   p->pid, (long long)p->arrival_time, (long long)p->last_active_time,
+                   (long long)(p->last_active_time - p->arrival_time),
+                   (long long)(times->waiting_time < 0 ? 0 : times->waiting_time), (long long)times->response_time);
+        }
+    }
+    arena_free(&ctx->arena, by_record, (size_t)ctx->num_processes * sizeof(int));
+
+    if (metrics->completed_count > 0) {
+        double makespan = metrics->total_makespan > 0 ? metrics->total_makespan : 1;
+        double capacity = metrics->total_makespan * num_cpus;   // CPU time available during the run
+        printf("\n--- Performance Metrics ---\n");
+        printf("Average Waiting Time: %.2f\n", stats_mean(&metrics->waiting.stats));
+        printf("Average Turnaround Time: %.2f\n", stats_mean(&metrics->turnaround.stats));
+        printf("\n           |      Mean |   Std Dev |     p50 |     p95 |     p99 |     Max\n");
+        printf("-----------|-----------|-----------|---------|---------|---------|--------\n");
+        print_distribution_row("Waiting", &metrics->waiting);
+        print_distribution_row("Turnaround", &metrics->turnaround);
+        print_distribution_row("Response", &metrics->response);
+        if (metrics->deadline_processes > 0) print_distribution_row("Lateness", &metrics->lateness);
+        if (metrics->share_windows > 0) print_distribution_row("Share Dev.", &metrics->share_deviation);
+        if (metrics->total_overhead_time > 0) {
+            printf("\nCPU Utilization: %.2f%% (busy %.0f + overhead %.0f of %.0f)\n",
+                   100.0 * (metrics->total_busy_time + metrics->total_overhead_time) / (makespan * num_cpus),
+                   metrics->total_busy_time, metrics->total_overhead_time, capacity);
+            printf("Effective Utilization: %.2f%% (useful work only)\n",
+                   100.0 * metrics->total_busy_time / (makespan * num_cpus));
+        } else {
+            printf("\nCPU Utilization: %.2f%% (busy %.0f of %.0f)\n",
+                   100.0 * metrics->total_busy_time / (makespan * num_cpus), metrics->total_busy_time, capacity);
+        }
+        printf("Throughput: %.4f processes per time unit\n", metrics->completed_count / makespan);
+        printf("Context Switches: %llu\n", (unsigned long long)metrics->context_switches);
+        if (metrics->deadline_processes > 0) {
+            printf("Deadline Misses: %llu of %llu (%.2f%%; lateness counts on-time completions as 0)\n",
+                   (unsigned long long)metrics->deadline_misses, (unsigned long long)metrics->deadline_processes,
+                   100.0 * metrics_miss_ratio(metrics));
+        }
+        if (metrics->share_windows > 0) {
+            printf("Share Error: %.2f%% of the entitled CPU time over %llu process windows of %d "
+                   "(share deviation is |received - entitled| per window)\n",
+                   100.0 * metrics_share_error(metrics), (unsigned long long)metrics->share_windows,
+                   ctx->policy.share.window);
+        }
+        if (metrics->total_overhead_time > 0) {
+            printf("Overhead: %.2f%% of CPU time; %llu switches (%llu after preemptions), %llu cache refills, "
+                   "%llu migrations\n", 100.0 * metrics->total_overhead_time / (makespan * num_cpus),
+                   (unsigned long long)metrics->context_switches, (unsigned long long)metrics->preemptions,
+                   (unsigned long long)metrics->cache_refills, (unsigned long long)metrics->migrations);
+        }
+        if (num_cpus > 1) {
+            printf("\nCPU | Busy       | Util %%  | Dispatches | Migrations | Steals\n");
+            printf("----|------------|---------|------------|------------|-------\n");
+            for (int c = 0; c < num_cpus; c++) {
+                const Cpu* cpu = &ctx->cpus[c];
+                printf("%3d | %10lld | %7.2f | %10llu | %10llu | %6llu\n", c, (long long)cpu->busy_time,
+                       100.0 * cpu->busy_time / makespan, (unsigned long long)cpu->dispatches,
+                       (unsigned long long)cpu->migrations, (unsigned long long)cpu->steals);
+            }
+            printf("Load Imbalance: %.2f%% (busiest CPU over the mean)\n", 100.0 * metrics->total_imbalance);
+            printf("Migrations: %llu (cost %d each), Steals: %llu\n", (unsigned long long)metrics->migrations,
+                   ctx->machine.migration_cost, (unsigned long long)metrics->steals);
+        }
+    } else {
+        printf("\nNo processes were completed to evaluate.\n");
+    }
+    print_instr_counters(&metrics->instr);
+    printf("Peak Memory: %.1f KB (workload %.1f KB, simulation %.1f KB)\n",
+           metrics->peak_memory / 1024.0, workload_bytes / 1024.0,
+           (metrics->peak_memory - workload_bytes) / 1024.0);
+}
+
+SIM_INLINE void schedule_event(SimContext* ctx, Process* p, int64_t time, int type) {
+    p->event_time = time;
+    p->event_type = (int8_t)type;
+    wheel_insert(&ctx->event_wheel, p);
+}
+
+// CFS slice of a process just dispatched: its weight's share of the scheduling period, which is
+// the target latency or, with more runnable processes than fit in it, min_granularity each
+SIM_INLINE int cfs_slice(SimContext* ctx, ReadyQueue* rq, Process* p) {
+    const CfsConfig* config = &ctx->policy.cfs;
+    int weight = ctx->cfs_entities[p - ctx->processes].weight;
+    int64_t runnable = (int64_t)rq->size + 1;
+    int64_t period = runnable * config->min_granularity;
+    if (period < config->target_latency) period = config->target_latency;
+    int64_t slice = period * weight / (rq->cfs.load + weight);
+    if (slice < 1) return 1;
+    return slice > INT_MAX ? INT_MAX : (int)slice;
+}
+
+// vruntime of a process joining the queue of `cpu`. Its vruntime is carried over relative to
+// the queue it last ran from; a new process starts at the queue's min_vruntime and a waking one
+// at most half a target latency behind it, so sleeping earns a bounded head start.
+SIM_INLINE void cfs_place(SimContext* ctx, Cpu* cpu, Process* p, int waking) {
+    CfsEntity* entity = &ctx->cfs_entities[p - ctx->processes];
+    CfsTree* tree = &cpu->ready_queue.cfs;
+    int64_t floor = tree->min_vruntime;
+    if (p->cpu >= 0 && p->cpu != cpu->id) {
+        entity->vruntime += floor - ctx->cpus[p->cpu].ready_queue.cfs.min_vruntime;
+    }
+    if (waking) floor -= ((int64_t)ctx->policy.cfs.target_latency << CFS_VRUNTIME_SHIFT) / 2;
+    if (entity->vruntime < floor) entity->vruntime = floor;
+}
+
+// Pass of a process joining the stride queue of `cpu`, carried over relative to the queue it last
+// ran from; ready_queue_push lifts it to the queue's min_pass
+SIM_INLINE void stride_place(SimContext* ctx, Cpu* cpu, Process* p) {
+    if (p->cpu >= 0 && p->cpu != cpu->id) {
+        ctx->stride_passes[p - ctx->processes] +=
+            cpu->ready_queue.share.min_pass - ctx->cpus[p->cpu].ready_queue.share.min_pass;
+    }
+}
+
+// Share accuracy of lottery and stride runs (see ShareClock). A process has one window open at a
+// time, in which it receives CPU time while running and is entitled to it while runnable; every
+// window closes with a sample of |received - entitled|.
+
+// Advance the fair-share clock of a CPU to `now`, keeping its value at the window ends passed
+void share_clock_advance(SimContext* ctx, ShareClock* clock, int64_t now) {
+    int64_t window = ctx->policy.share.window;
+    while ((clock->windows + 1) * window <= now) {
+        int64_t end = (clock->windows + 1) * window;
+        if (clock->tickets > 0) clock->vtime += (double)(end - clock->since) / (double)clock->tickets;
+        if (clock->windows == clock->capacity) {
+            int64_t capacity = clock->capacity > 0 ? clock->capacity * 2 : 64;
+            clock->boundary = arena_grow(&ctx->arena, clock->boundary, (size_t)clock->capacity * sizeof(double),
+                                         (size_t)capacity * sizeof(double));
+            clock->capacity = capacity;
+        }
+        clock->boundary[clock->windows++] = clock->vtime;
+        clock->since = end;
+    }
+    if (clock->tickets > 0) clock->vtime += (double)(now - clock->since) / (double)clock->tickets;
+    clock->since = now;
+}
+
+// `count` windows with `entitled` CPU time and `error` away from it in total, the same in each
+void share_record(SimMetrics* metrics, double entitled, double error, uint64_t count) {
+    metrics->share_windows += count;
+    metrics->share_entitled += entitled;
+    metrics->share_error += error;
+    double deviation = error / (double)count + 0.5;
+    distribution_add_repeated(&metrics->share_deviation, deviation < (double)INT64_MAX ? (int64_t)deviation : INT64_MAX,
+                              count);
+}
+
+void share_close_window(SimContext* ctx, ShareState* state) {
+    if (state->received > 0 || state->entitled > 0) {
+        share_record(&ctx->metrics, state->entitled, fabs((double)state->received - state->entitled), 1);
+    }
+    state->received = 0;
+    state->entitled = 0;
+}
+
+// Account a runnable process up to `now`: its entitlement and, if it was `running` since the last
+// update, the CPU time it received. Whole windows in between are recorded at once; in each it
+// received all or none of the CPU, never less than its entitlement or more, so their error is exact.
+void share_update(SimContext* ctx, Process* p, int64_t now, int running) {
+    int index = (int)(p - ctx->processes);
+    ShareState* state = &ctx->shares[index];
+    ShareClock* clock = &ctx->cpus[state->cpu].share_clock;
+    int64_t window = ctx->policy.share.window;
+    double tickets = ctx->tickets[index];
+    share_clock_advance(ctx, clock, now);
+    int64_t current = now / window;
+    if (state->window < current) {
+        double end_vtime = clock->boundary[state->window];
+        if (running) state->received += (state->window + 1) * window - state->last;
+        state->entitled += tickets * (end_vtime - state->vmark);
+        share_close_window(ctx, state);
+        int64_t whole = current - state->window - 1;
+        if (whole > 0) {
+            double entitled = tickets * (clock->boundary[current - 1] - end_vtime);
+            share_record(&ctx->metrics, entitled, running ? (double)whole * (double)window - entitled : entitled,
+                         (uint64_t)whole);
+        }
+        state->window = current;
+        state->last = current * window;
+        state->vmark = clock->boundary[current - 1];
+    }
+    if (running) state->received += now - state->last;
+    state->entitled += tickets * (clock->vtime - state->vmark);
+    state->last = now;
+    state->vmark = clock->vtime;
+}
+
+// A process becomes runnable on `cpu`
+void share_join(SimContext* ctx, Cpu* cpu, Process* p, int64_t now) {
+    int index = (int)(p - ctx->processes);
+    ShareState* state = &ctx->shares[index];
+    ShareClock* clock = &cpu->share_clock;
+    share_clock_advance(ctx, clock, now);
+    int64_t current = now / ctx->policy.share.window;
+    if (state->window != current) {
+        share_close_window(ctx, state);     // Left open when it last blocked
+        state->window = current;
+    }
+    state->cpu = cpu->id;
+    state->last = now;
+    state->vmark = clock->vtime;
+    clock->tickets += ctx->tickets[index];
+}
+
+// A process accounted up to now stops being runnable
+void share_leave(SimContext* ctx, Process* p) {
+    int index = (int)(p - ctx->processes);
+    ShareState* state = &ctx->shares[index];
+    ctx->cpus[state->cpu].share_clock.tickets -= ctx->tickets[index];
+    state->cpu = -1;
+}
+
+// A process dispatched on `cpu`: its waiting time is accounted, and if it was taken from another
+// CPU's queue it follows this CPU's clock from now on
+void share_dispatch(SimContext* ctx, Cpu* cpu, Process* p, int64_t now) {
+    share_update(ctx, p, now, 0);
+    if (ctx->shares[p - ctx->processes].cpu != cpu->id) {
+        share_leave(ctx, p);
+        share_join(ctx, cpu, p, now);
+    }
+}
+
+// Schedule the next stop of a freshly dispatched process: I/O request, completion or quantum expiry.
+// The whole CPU burst up to that point is accounted at once when the event fires, and every
+// slice starts at a dispatch.
+SIM_INLINE void schedule_cpu_event(SimContext* ctx, Process* p, int64_t current_time, enum SchedulingMode mode) {
+    int run = p->remaining_cpu_total;
+    int type = EVENT_CPU_COMPLETE;
+
+    // 다음 I/O 요청 시점 (이미 지난 요청 시점은 다시 오지 않음)
+    if (p->io_left > 0) {
+        int request = ctx->phases != NULL ? p->io_next : ctx->io_operations[p->io_next].request_time;
+        int until_io = request - (p->cpu_burst_time - p->remaining_cpu_total);
+        if (until_io > 0 && until_io < run) {
+            run = until_io;
+            type = EVENT_IO_REQUEST;
+        }
+    }
+
+    // I/O 요청이나 완료와 같은 시점이면 quantum 만료보다 우선
+    if (mode == RR_MODE || mode == MLFQ_MODE || mode == CFS_MODE || share_mode(mode)) {
+        int quantum = mode == MLFQ_MODE ? ctx->policy.mlfq.quanta[p->mlfq_level]
+                    : mode == CFS_MODE  ? cfs_slice(ctx, &ctx->cpus[p->cpu].ready_queue, p)
+                                        : ctx->policy.time_quantum;
+        if (quantum < run) {
+            run = quantum;
+            type = EVENT_QUANTUM_EXPIRE;
+        }
+    }
+
+    schedule_event(ctx, p, current_time + run, type);
+}
+
+// Account CPU time for a whole burst [start, end)
+void simulate_process_run(Process* p, int64_t start, int64_t end) {
+    p->remaining_cpu_total -= (int)(end - start);
+}
+
+// Per-CPU ready queue operations; they keep the context's CPU bitmaps up to date
+SIM_INLINE void cpu_enqueue(SimContext* ctx, Cpu* cpu, Process* p, enum SchedulingMode mode) {
+    ready_queue_push(&cpu->ready_queue, p, mode);
+    cpu_mask_set(&ctx->queued, cpu->id);
+    cpu_mask_clear(&ctx->available, cpu->id);
+    cpu_mask_set(&ctx->dirty, cpu->id);
+}
+
+SIM_INLINE Process* cpu_dequeue(SimContext* ctx, Cpu* cpu, enum SchedulingMode mode) {
+    Process* p = ready_queue_pop(&cpu->ready_queue, mode);
+    if (cpu->ready_queue.size == 0) cpu_mask_clear(&ctx->queued, cpu->id);
+    return p;
+}
+
+// CPU whose queue a ready process joins: its last CPU if that is free, else any free CPU it may
+// use, else its last CPU, else the next allowed CPU in round-robin order. Load left uneven by
+// this choice is evened out by stealing.
+SIM_INLINE Cpu* place_process(SimContext* ctx, Process* p) {
+    int num_cpus = ctx->machine.num_cpus;
+    if (num_cpus == 1) return &ctx->cpus[0];
+
+    int last = p->cpu;
+    const CpuMask* affinity = process_affinity(ctx, p);
+    if (last >= 0 && cpu_mask_test(&ctx->available, last) && cpu_allowed(affinity, last)) return &ctx->cpus[last];
+    int idle = cpu_mask_first_common(&ctx->available, affinity);
+    if (idle >= 0) return &ctx->cpus[idle];
+    if (last >= 0 && cpu_allowed(affinity, last)) return &ctx->cpus[last];
+    for (int i = 0; i < num_cpus; i++) {
+        int c = ctx->next_cpu;
+        ctx->next_cpu = c + 1 < num_cpus ? c + 1 : 0;
+        if (cpu_allowed(affinity, c)) return &ctx->cpus[c];
+    }
+    return &ctx->cpus[0];   // Affinity masks are checked against the CPU count when loaded
+}
+
+// Work stealing: an idle CPU takes the first waiting process of the longest queue behind a busy
+// CPU, if the process may run on the thief. Only CPUs with queued processes are visited.
+SIM_INLINE Process* cpu_steal(SimContext* ctx, Cpu* thief, enum SchedulingMode mode) {
+    Cpu* victim = NULL;
+    for (int w = 0; w < CPU_MASK_WORDS; w++) {
+        uint64_t bits = ctx->queued.bits[w];
+        while (bits != 0) {
+            Cpu* cpu = &ctx->cpus[w * 64 + find_first_set(bits)];
+            bits &= bits - 1;
+            if (cpu == thief || cpu->running == NULL) continue;     // An idle CPU runs its own queue
+            if ((victim == NULL || cpu->ready_queue.size > victim->ready_queue.size) &&
+                cpu_allowed(process_affinity(ctx, ready_queue_peek(&cpu->ready_queue, mode)), thief->id)) {
+                victim = cpu;
+            }
+        }
+    }
+    if (victim == NULL) return NULL;
+    thief->steals++;
+    Process* p = cpu_dequeue(ctx, victim, mode);
+    if (mode == CFS_MODE) {
+        ctx->cfs_entities[p - ctx->processes].vruntime +=
+            thief->ready_queue.cfs.min_vruntime - victim->ready_queue.cfs.min_vruntime;
+    }
+    if (mode == STRIDE_MODE) {
+        ctx->stride_passes[p - ctx->processes] +=
+            thief->ready_queue.share.min_pass - victim->ready_queue.share.min_pass;
+    }
+    return p;
+}
+
+// Gantt slices and overhead time of the running process from its dispatch to `now`; it made
+// progress from `from` on
+SIM_INLINE void cpu_record_stint(SimContext* ctx, Cpu* cpu, int pid, int64_t from, int64_t now) {
+    if (from > cpu->dispatch_time) {
+        cpu->overhead_time += from - cpu->dispatch_time;
+        add_gantt_overhead(ctx, cpu, pid, cpu->dispatch_time, from);
+        if (now > from) add_gantt_entry(ctx, cpu, pid, from, now);
+    } else {
+        add_gantt_entry(ctx, cpu, pid, cpu->dispatch_time, now);
+    }
+}
+
+// Account the running process's CPU time up to `now` and give the CPU up
+SIM_INLINE Process* cpu_stop(SimContext* ctx, Cpu* cpu, int64_t now, enum SchedulingMode mode) {
+    Process* p = cpu->running;
+    int64_t from = cpu->run_start < now ? cpu->run_start : now;     // Preempted during the overhead: no progress
+    simulate_process_run(p, from, now);
+    if (mode == CFS_MODE) {
+        CfsEntity* entity = &ctx->cfs_entities[p - ctx->processes];
+        entity->vruntime += cfs_vtime(now - from, entity->weight);
+    }
+    if (share_mode(mode)) {
+        int index = (int)(p - ctx->processes);
+        ctx->stride_passes[index] += (now - from) * (STRIDE_ONE / ctx->tickets[index]);
+        if (ctx->shares != NULL) share_update(ctx, p, now, 1);
+    }
+    cpu->busy_time += now - from;
+    cpu_record_stint(ctx, cpu, p->pid, from, now);
+    if (ctx->off_cpu_since != NULL) ctx->off_cpu_since[p - ctx->processes] = now;
+    cpu->running = NULL;
+    cpu->idle_since = now;
+    cpu_mask_set(&ctx->dirty, cpu->id);
+    return p;
+}
+
+// Preemption check and dispatch on one CPU; returns 1 if the CPU went from idle to running
+SIM_INLINE int cpu_schedule(SimContext* ctx, Cpu* cpu, int64_t current_time, enum SchedulingMode mode,
+                            enum PreemptionMode preemption_mode) {
+    Process* running_process = cpu->running;
+    int was_running = running_process != NULL;
+
+    // 2. Preemption logic ONLY for preemptive algorithms
+    if (running_process != NULL && cpu->ready_queue.size != 0 && preemption_mode == PREEMPTIVE) {
+        Process* potential_preemptor = ready_queue_peek(&cpu->ready_queue, mode);
+        int64_t ran = current_time > cpu->run_start ? current_time - cpu->run_start : 0;
+        int64_t running_remaining = running_process->remaining_cpu_total - ran;
+        int should_preempt = 0;
+
+        if (mode == SJF_MODE &&
+            potential_preemptor->remaining_cpu_total < running_remaining) {
+            should_preempt = 1;
+        } else if ((mode == PRIORITY_MODE || realtime_mode(mode)) &&
+                   potential_preemptor->priority < running_process->priority) {
+            should_preempt = 1;
+        } else if (mode == MLFQ_MODE &&
+                   potential_preemptor->mlfq_level < running_process->mlfq_level) {
+            should_preempt = 1;
+        } else if (mode == CFS_MODE) {
+            // Wakeup preemption: the running process is ahead by more than a minimum granularity
+            const CfsEntity* current = &ctx->cfs_entities[running_process - ctx->processes];
+            const CfsEntity* waking = &ctx->cfs_entities[potential_preemptor - ctx->processes];
+            int64_t current_vruntime = current->vruntime + cfs_vtime(ran, current->weight);
+            should_preempt = current_vruntime - waking->vruntime >
+                             cfs_vtime(ctx->policy.cfs.min_granularity, waking->weight);
+        }
+
+        if (should_preempt) {
+            wheel_cancel(&ctx->event_wheel, running_process);   // Cancel its pending CPU event
+            running_process->event_type = EVENT_NONE;
+            cpu_stop(ctx, cpu, current_time, mode);    // 기존 process gantt에 기록
+            cpu->preempted = 1;
+            trace_emit(ctx, TRACE_PREEMPT, running_process->pid, current_time, current_time,
+                       potential_preemptor->pid, cpu->id);
+            INSTR_COUNT(ctx->metrics.instr.preemptions);
+            running_process->last_active_time = current_time;
+            cpu_enqueue(ctx, cpu, running_process, mode);
+            running_process = NULL;
+        }
+    }
+    PHASE_END(PHASE_PREEMPTION);
+
+    // 3. Dispatch if CPU is idle: its own queue first, then other CPUs' queues
+    if (running_process == NULL) {
+        Process* next_p = NULL;
+        if (cpu->ready_queue.size != 0) {
+            next_p = cpu_dequeue(ctx, cpu, mode);
+        } else if (ctx->machine.num_cpus > 1) {
+            next_p = cpu_steal(ctx, cpu, mode);
+        }
+
+        if (next_p == NULL) {
+            cpu_mask_set(&ctx->available, cpu->id);
+        } else {
+            // The former per-tick loop started recording idle time at t=1; keep the same Gantt chart
+            int64_t idle_start = (cpu->idle_since == 0) ? 1 : cpu->idle_since;
+            if (!was_running && current_time > idle_start) {
+                add_gantt_entry(ctx, cpu, 0, idle_start, current_time);
+            }
+
+            running_process = next_p;
+            if (share_mode(mode) && ctx->shares != NULL) share_dispatch(ctx, cpu, running_process, current_time);
+            ProcessTimes* times = &ctx->times[running_process - ctx->processes];
+            if (times->response_time < 0) times->response_time = current_time - running_process->arrival_time;
+            times->waiting_time += current_time - running_process->last_active_time;
+            if (current_time > running_process->last_active_time) {
+                trace_emit(ctx, TRACE_READY, running_process->pid, running_process->last_active_time,
+                           current_time, 0, cpu->id);
+            }
+            // The process makes no progress until the overhead of getting it onto this CPU is spent:
+            // a context switch, a preemption before it, a cache refill and a migration
+            const MachineConfig* machine = &ctx->machine;
+            int64_t run_start = current_time;
+            cpu->dispatch_time = current_time;
+            if (cpu->last_dispatched != NULL && cpu->last_dispatched != running_process) {
+                ctx->metrics.context_switches++;
+                run_start += machine->dispatch_cost;
+                if (cpu->preempted) {
+                    ctx->metrics.preemptions++;
+                    run_start += machine->preemption_cost;
+                }
+            }
+            cpu->preempted = 0;
+            cpu->last_dispatched = running_process;
+            cpu->dispatches++;
+            ctx->metrics.dispatches++;
+            if (machine->refill_cost > 0) {
+                // Cold on the first dispatch; warm again only if it just left
+                int64_t off = running_process->cpu < 0 ? machine->refill_time
+                            : current_time - ctx->off_cpu_since[running_process - ctx->processes];
+                if (off > 0) {
+                    if (off > machine->refill_time) off = machine->refill_time;
+                    run_start += machine->refill_cost * off / machine->refill_time;
+                    ctx->metrics.cache_refills++;
+                }
+            }
+            if (running_process->cpu >= 0 && running_process->cpu != cpu->id) {
+                cpu->migrations++;
+                run_start += machine->migration_cost;
+            }
+            cpu->run_start = run_start;
+            running_process->cpu = cpu->id;
+            cpu->running = running_process;
+            schedule_cpu_event(ctx, running_process, cpu->run_start, mode);
+        }
+    }
+    PHASE_END(PHASE_DISPATCH);
+    return !was_running && cpu->running != NULL;
+}
+
+// MLFQ priority boost: every process goes back to level 0. Queued processes keep their order,
+// higher levels first; running ones finish their current slice. Processes waiting for I/O are
+// boosted when they return (mlfq_io_return), so a boost costs O(queued processes).
+void mlfq_boost(SimContext* ctx) {
+    for (int c = 0; c < ctx->machine.num_cpus; c++) {
+        Cpu* cpu = &ctx->cpus[c];
+        ReadyQueue* rq = &cpu->ready_queue;
+        uint64_t lower = rq->level_bitmap & ~(uint64_t)1;
+        while (lower != 0) {
+            int level = find_first_set(lower);
+            lower &= lower - 1;
+            while (rq->levels[level].size != 0) {
+                Process* p = fifo_pop(&rq->levels[level]);
+                p->mlfq_level = 0;
+                fifo_push(&rq->levels[0], p);
+            }
+        }
+        if (rq->level_bitmap != 0) rq->level_bitmap = 1;
+        if (cpu->running != NULL) cpu->running->mlfq_level = 0;
+    }
+    INSTR_COUNT(ctx->metrics.instr.mlfq_boosts);
+}
+
+// Level of a process back from I/O: one up, or the top if a boost happened while it waited.
+// Its last_active_time is still the start of the I/O.
+SIM_INLINE void mlfq_io_return(SimContext* ctx, Process* p, int64_t now) {
+    int period = ctx->policy.mlfq.boost_period;
+    int64_t io_start = p->last_active_time;
+    if (period > 0 && io_start / period != now / period) {
+        p->mlfq_level = 0;
+    } else if (p->mlfq_level > 0) {
+        p->mlfq_level--;
+    }
+}
+
+// Take the next process of the stream into a free slot and schedule its arrival
+void stream_admit(SimContext* ctx, int64_t now) {
+    StreamState* stream = ctx->stream;
+    int slot = stream->free_slot >= 0 ? stream->free_slot : stream->used_slots;
+    if (slot >= STREAM_MAX_LIVE) {
+        if (!stream->overflow) {
+            fprintf(stderr, "More than %d processes in the system at time %lld; no further arrivals\n",
+                    STREAM_MAX_LIVE, (long long)now);
+        }
+        stream->overflow = 1;
+        return;
+    }
+    WorkloadRecord r;
+    int64_t arrival;
+    IOOperation* io = &stream->io[(size_t)slot * MAX_IO_OPERATIONS];
+    if (!stream_source_next(&stream->source, &r, io, &arrival)) return;
+
+    Process* p = &ctx->processes[slot];
+    if (slot == stream->free_slot) {
+        stream->free_slot = p->event_next;
+    } else {
+        stream->used_slots++;
+    }
+    r.io_first = (uint32_t)slot * MAX_IO_OPERATIONS;
+    process_init(ctx, p, &r, arrival);
+    if (ctx->scheduling_mode == CFS_MODE) {
+        ctx->cfs_entities[slot].vruntime = 0;
+        ctx->cfs_entities[slot].weight = cfs_weight(p->priority);
+    }
+    if (share_mode(ctx->scheduling_mode)) {
+        ctx->tickets[slot] = cfs_weight(p->priority);
+        ctx->stride_passes[slot] = 0;
+    }
+    stream->admitted++;
+    if (++stream->live > stream->peak_live) stream->peak_live = stream->live;
+    schedule_event(ctx, p, p->arrival_time, EVENT_ARRIVAL);
+}
+
+// A completed process leaves the system; its slot is reused by a later one
+void stream_retire(SimContext* ctx, Process* p) {
+    StreamState* stream = ctx->stream;
+    StreamWindow* window = &stream->windows[stream->current_window];
+    window->completed++;
+    distribution_add(&window->waiting, ctx->times[p - ctx->processes].waiting_time);
+    // The next process in this slot is another one to the context switch count
+    for (int c = 0; c < ctx->machine.num_cpus; c++) {
+        if (ctx->cpus[c].last_dispatched == p) ctx->cpus[c].last_dispatched = &stream->departed;
+    }
+    p->event_next = stream->free_slot;
+    stream->free_slot = (int)(p - ctx->processes);
+    stream->live--;
+}
+
+// Event loop; `mode` is a constant at every call site so each mode gets its own ready queue code.
+// Every CPU keeps its own ready queue; only CPUs touched by the events of an instant are
+// rescheduled, so an instant costs the same for any number of CPUs.
+// Runs until every process completed (returns 1) or until every event before `until` is handled
+// (returns 0, checkpoint_time is then `until`); the loop position is kept in the context.
+SIM_INLINE int simulate_events(SimContext* ctx, const char* algo_name, enum SchedulingMode mode,
+                               enum PreemptionMode preemption_mode, int64_t until) {
+    Process* processes = ctx->processes;
+    int num_processes = ctx->num_processes;
+    TimingWheel* event_wheel = &ctx->event_wheel;
+
+    // Loop state lives in locals while running
+    int64_t current_time = ctx->current_time;
+    int completed_count = ctx->completed_count;
+    int running_count = ctx->running_count;
+    int next_arrival_idx = ctx->next_arrival_idx;
+    int boost_period = ctx->policy.mlfq.boost_period;
+    int64_t next_boost = ctx->next_boost;
+    int finished = 1;
+    ctx->checkpoint_time = -1;
+#if SIM_INSTRUMENT >= 2
+    static const int event_phases[] = {
+        [EVENT_NONE] = PHASE_ADVANCE,
+        [EVENT_ARRIVAL] = PHASE_ARRIVALS,
+        [EVENT_IO_COMPLETE] = PHASE_IO,
+        [EVENT_IO_REQUEST] = PHASE_IO,
+        [EVENT_CPU_COMPLETE] = PHASE_ADVANCE,
+        [EVENT_QUANTUM_EXPIRE] = PHASE_PREEMPTION,
+    };
+#endif
+    PHASE_START();
+
+    while (completed_count < num_processes) {
+        // Jump straight to the next event; idle CPUs stay idle in between
+        int64_t next_event_time = wheel_advance(event_wheel, until - 1);
+        if (next_event_time < 0 && event_wheel->size > 0) {
+            ctx->checkpoint_time = until;
+            finished = 0;
+            break;
+        }
+        if (next_event_time < 0 && ctx->stream != NULL) break;     // The stream ran dry
+        if (next_event_time < 0) {
+            printf("Simulation for %s possibly stuck. Time: %lld, Completed: %d/%d\n",
+                   algo_name, (long long)current_time, completed_count, num_processes);
+            break;
+        }
+        if (running_count == 0 && next_event_time > current_time) {
+            INSTR_COUNT(ctx->metrics.instr.idle_fast_forwards);
+        }
+        current_time = next_event_time;
+        // Boosts between events change nothing until the next scheduling decision
+        if (mode == MLFQ_MODE && current_time >= next_boost) {
+            mlfq_boost(ctx);
+            next_boost = (current_time / boost_period + 1) * boost_period;
+        }
+        PHASE_END(PHASE_ADVANCE);
+
+        // 1. Handle every event due at this instant
+        Process* p;
+        Cpu* cpu;
+        int64_t io_done;
+        while ((p = wheel_pop_due(event_wheel)) != NULL) {
+            int type = p->event_type;
+            p->event_type = EVENT_NONE;
+            ctx->metrics.events++;
+
+            switch (type) {
+                case EVENT_ARRIVAL:
+                    p->last_active_time = current_time;
+                    cpu = place_process(ctx, p);
+                    if (mode == CFS_MODE) cfs_place(ctx, cpu, p, 0);
+                    if (mode == STRIDE_MODE) stride_place(ctx, cpu, p);
+                    if (share_mode(mode) && ctx->shares != NULL) share_join(ctx, cpu, p, current_time);
+                    cpu_enqueue(ctx, cpu, p, mode);
+                    if (ctx->stream != NULL) {
+                        stream_admit(ctx, current_time);
+                    } else if (next_arrival_idx < num_processes) {
+                        Process* next_p = &processes[next_arrival_idx++];
+                        schedule_event(ctx, next_p, next_p->arrival_time, EVENT_ARRIVAL);
+                    }
+                    break;
+
+                case EVENT_IO_COMPLETE:
+                    if (mode == MLFQ_MODE) mlfq_io_return(ctx, p, current_time);
+                    p->last_active_time = current_time;   //waiting time 계산 위해서 ready queue 입장 시간 기록
+                    cpu = place_process(ctx, p);
+                    if (mode == CFS_MODE) cfs_place(ctx, cpu, p, 1);
+                    if (mode == STRIDE_MODE) stride_place(ctx, cpu, p);
+                    if (share_mode(mode) && ctx->shares != NULL) share_join(ctx, cpu, p, current_time);
+                    cpu_enqueue(ctx, cpu, p, mode);
+                    INSTR_COUNT(ctx->metrics.instr.io_completions);
+                    break;
+
+                case EVENT_IO_REQUEST:
+                    cpu_stop(ctx, &ctx->cpus[p->cpu], current_time, mode);
+                    if (share_mode(mode) && ctx->shares != NULL) share_leave(ctx, p);
+                    running_count--;
+                    p->last_active_time = current_time;
+                    // I/O 작업 시작
+                    if (ctx->phases != NULL) {
+                        io_done = current_time + phase_advance(ctx->phases, p, p->cpu_burst_time - p->remaining_cpu_total);
+                    } else {
+                        io_done = current_time + ctx->io_operations[p->io_next].burst_time;
+                        p->io_next++; // 다음 I/O 작업으로 이동
+                        p->io_left--;
+                    }
+                    trace_emit(ctx, TRACE_IO, p->pid, current_time, io_done, 0, 0);
+                    INSTR_COUNT(ctx->metrics.instr.io_requests);
+                    schedule_event(ctx, p, io_done, EVENT_IO_COMPLETE);
+                    break;
+
+                case EVENT_CPU_COMPLETE:
+                    cpu_stop(ctx, &ctx->cpus[p->cpu], current_time, mode);
+                    if (share_mode(mode) && ctx->shares != NULL) {
+                        share_leave(ctx, p);
+                        share_close_window(ctx, &ctx->shares[p - processes]);
+                    }
+                    running_count--;
+                    p->last_active_time = current_time;
+                    metrics_record_completion(&ctx->metrics, p, &ctx->times[p - processes], current_time);
+                    if (ctx->realtime != NULL) metrics_record_deadline(ctx, p, current_time);
+                    if (ctx->stream != NULL) {
+                        stream_retire(ctx, p);
+                    } else {
+                        completed_count++;
+                    }
+                    break;
+
+                case EVENT_QUANTUM_EXPIRE: // RR Preemption, MLFQ demotion, end of a CFS slice or share quantum
+                    cpu = &ctx->cpus[p->cpu];
+                    cpu_stop(ctx, cpu, current_time, mode);
+                    cpu->preempted = 1;
+                    running_count--;
+                    trace_emit(ctx, TRACE_PREEMPT, p->pid, current_time, current_time, 0, cpu->id);
+                    INSTR_COUNT(ctx->metrics.instr.quantum_expiries);
+                    if (mode == MLFQ_MODE && p->mlfq_level + 1 < ctx->policy.mlfq.num_levels) p->mlfq_level++;
+                    p->last_active_time = current_time;
+                    cpu_enqueue(ctx, cpu, p, mode);
+                    break;
+            }
+#if SIM_INSTRUMENT >= 2
+            PHASE_END(event_phases[type]);
+#endif
+        }
+
+        // 2, 3. Preemption and dispatch on every CPU the events touched
+        for (int w = 0; w < CPU_MASK_WORDS; w++) {
+            uint64_t bits = ctx->dirty.bits[w];
+            ctx->dirty.bits[w] = 0;
+            while (bits != 0) {
+                Cpu* cpu = &ctx->cpus[w * 64 + find_first_set(bits)];
+                bits &= bits - 1;
+                running_count += cpu_schedule(ctx, cpu, current_time, mode, preemption_mode);
+            }
+        }
+    }
+
+    ctx->current_time = current_time;
+    ctx->completed_count = completed_count;
+    ctx->running_count = running_count;
+    ctx->next_arrival_idx = next_arrival_idx;
+    ctx->next_boost = next_boost;
+    return finished;
+}
+
+// Add the heap counters of this run's queues to the run's instrumentation
+void instr_collect_heaps(SimContext* ctx, enum SchedulingMode mode) {
+#if SIM_INSTRUMENT
+    HeapCounters* total = &ctx->metrics.instr.heap;
+    heap_counters_merge(total, &ctx->event_wheel.due.counters);
+    ctx->metrics.instr.wheel_cascades += ctx->event_wheel.cascades;
+    for (int c = 0; c < ctx->machine.num_cpus; c++) {
+        ReadyQueue* ready_queue = &ctx->cpus[c].ready_queue;
+        if (mode == FCFS_MODE || mode == SJF_MODE || realtime_mode(mode) || mode == STRIDE_MODE) {
+            heap_counters_merge(total, &ready_queue->heap.counters);
+        } else if (mode == PRIORITY_MODE) {
+            for (int level = 0; level < ready_queue->num_buckets; level++) {
+                heap_counters_merge(total, &ready_queue->buckets[level].counters);
+            }
+        } else if (mode == CFS_MODE) {
+            ctx->metrics.instr.cfs_rotations += ready_queue->cfs.rotations;
+        }
+    }
+#else
+    (void)ctx;
+    (void)mode;
+#endif
+}
+
+// CFS entities of this run (vruntime 0, weight from the priority) and an empty tree per CPU
+void cfs_reset(SimContext* ctx) {
+    int nil = ctx->num_processes;
+    if (ctx->stream != NULL) {
+        ctx->cfs_entities = ctx->stream->cfs_entities;     // Set up as processes arrive
+    } else {
+        ctx->cfs_entities = arena_alloc(&ctx->arena, (size_t)(nil + 1) * sizeof(CfsEntity));
+        for (int i = 0; i < nil; i++) {
+            ctx->cfs_entities[i].vruntime = 0;
+            ctx->cfs_entities[i].weight = cfs_weight(ctx->processes[i].priority);
+        }
+    }
+    memset(&ctx->cfs_entities[nil], 0, sizeof(CfsEntity));    // Black sentinel
+    for (int c = 0; c < ctx->machine.num_cpus; c++) {
+        cfs_tree_init(&ctx->cpus[c].ready_queue.cfs, ctx->cfs_entities, ctx->processes, nil);
+    }
+}
+
+// Tickets (from --shares or the priority's CFS weight), passes and per-CPU queue state of a lottery
+// or stride run; `measure`: also track share accuracy, over windows from time 0
+void share_reset(SimContext* ctx, int measure) {
+    int num_processes = ctx->num_processes;
+    StreamState* stream = ctx->stream;
+    if (stream != NULL) {
+        ctx->tickets = stream->tickets;     // Set up as processes arrive
+        ctx->stride_passes = stream->stride_passes;
+    } else {
+        const int* shares = ctx->workload->shares;
+        ctx->tickets = arena_alloc(&ctx->arena, (size_t)num_processes * sizeof(int));
+        ctx->stride_passes = arena_alloc(&ctx->arena, (size_t)num_processes * sizeof(int64_t));
+        for (int i = 0; i < num_processes; i++) {
+            Process* p = &ctx->processes[i];
+            ctx->tickets[i] = shares != NULL ? shares[process_record(ctx, p)] : cfs_weight(p->priority);
+            ctx->stride_passes[i] = 0;
+        }
+    }
+    ctx->shares = NULL;
+    if (measure && stream == NULL) {
+        ctx->shares = arena_alloc(&ctx->arena, (size_t)num_processes * sizeof(ShareState));
+        memset(ctx->shares, 0, (size_t)num_processes * sizeof(ShareState));
+        for (int i = 0; i < num_processes; i++) ctx->shares[i].cpu = -1;
+    }
+    for (int c = 0; c < ctx->machine.num_cpus; c++) {
+        Cpu* cpu = &ctx->cpus[c];
+        ShareQueue* queue = &cpu->ready_queue.share;
+        queue->tickets = ctx->tickets;
+        queue->passes = ctx->stride_passes;
+        queue->processes = ctx->processes;
+        queue->min_pass = 0;
+        rng_seed(&queue->rng, ctx->policy.share.seed, (uint64_t)c);
+        memset(&cpu->share_clock, 0, sizeof(cpu->share_clock));
+    }
+}
+
+// Set up a run of `mode` on the context's workload; sim_run_until then advances it
+void sim_start(SimContext* ctx, const char* algo_name, enum SchedulingMode mode,
+               enum PreemptionMode preemption_mode) {
+    reset_processes_for_simulation(ctx);
+    if (realtime_mode(mode) && ctx->stream == NULL) process_set_priorities(ctx, mode);
+    int queued = ctx->stream != NULL ? STREAM_QUEUE_HINT : ctx->num_processes;
+    int queue_capacity = queued / ctx->machine.num_cpus;     // Queues grow on demand
+    for (int c = 0; c < ctx->machine.num_cpus; c++) {
+        ready_queue_reset(&ctx->cpus[c].ready_queue, mode, &ctx->arena, queue_capacity, ctx->policy.mlfq.num_levels,
+                          ctx->priorities);
+    }
+    ctx->cfs_entities = NULL;
+    if (mode == CFS_MODE) cfs_reset(ctx);
+    ctx->tickets = NULL;
+    ctx->stride_passes = NULL;
+    ctx->shares = NULL;
+    if (share_mode(mode)) share_reset(ctx, ctx->policy.share.window > 0);
+    ctx->scheduling_mode = mode;
+    ctx->preemption_mode = preemption_mode;
+    metrics_reset(&ctx->metrics, ctx->num_processes);
+
+    ctx->current_time = 0;
+    ctx->completed_count = 0;
+    ctx->running_count = 0;
+    ctx->next_arrival_idx = 0;
+    int boost_period = ctx->policy.mlfq.boost_period;
+    ctx->next_boost = mode == MLFQ_MODE && boost_period > 0 ? boost_period : INT64_MAX;
+    if (ctx->stream != NULL) {
+        stream_admit(ctx, 0);
+    } else if (ctx->num_processes > 0) {
+        schedule_event(ctx, &ctx->processes[0], ctx->processes[0].arrival_time, EVENT_ARRIVAL);
+        ctx->next_arrival_idx = 1;
+    }
+
+    if (ctx->verbose) {
+        printf("\n--- Running");
+        int fixed = mode == RR_MODE || mode == FCFS_MODE || mode == MLFQ_MODE || mode == CFS_MODE ||
+                    realtime_mode(mode) || share_mode(mode);
+        if (preemption_mode == NON_PREEMPTIVE && !fixed) {
+            printf(" Non-Preemptive");
+        } else if (preemption_mode == PREEMPTIVE && !fixed) {
+            printf(" Preemptive");
+        }
+        printf(" %s Scheduler ------\n", algo_name);
+    }
+}
+
+// Advance the run to time `until`: every event before it is handled, none at or after it
+// (see simulate_events). Returns 1 once the run is over.
+int sim_run_until(SimContext* ctx, const char* algo_name, int64_t until) {
+    enum PreemptionMode preemption_mode = ctx->preemption_mode;
+    switch (ctx->scheduling_mode) {
+        case FCFS_MODE:
+            return simulate_events(ctx, algo_name, FCFS_MODE, preemption_mode, until);
+        case SJF_MODE:
+            return simulate_events(ctx, algo_name, SJF_MODE, preemption_mode, until);
+        case PRIORITY_MODE:
+            return simulate_events(ctx, algo_name, PRIORITY_MODE, preemption_mode, until);
+        case RR_MODE:
+            return simulate_events(ctx, algo_name, RR_MODE, preemption_mode, until);
+        case MLFQ_MODE:
+            return simulate_events(ctx, algo_name, MLFQ_MODE, preemption_mode, until);
+        case CFS_MODE:
+            return simulate_events(ctx, algo_name, CFS_MODE, preemption_mode, until);
+        case EDF_MODE:
+            return simulate_events(ctx, algo_name, EDF_MODE, preemption_mode, until);
+        case RM_MODE:
+            return simulate_events(ctx, algo_name, RM_MODE, preemption_mode, until);
+        case LOTTERY_MODE:
+            return simulate_events(ctx, algo_name, LOTTERY_MODE, preemption_mode, until);
+        case STRIDE_MODE:
+            return simulate_events(ctx, algo_name, STRIDE_MODE, preemption_mode, until);
+    }
+    return 1;
+}
+
+// Close the Gantt chart and metrics of a finished run and print its report
+void sim_finish(SimContext* ctx, const char* algo_name) {
+    for (int c = 0; c < ctx->machine.num_cpus; c++) {
+        gantt_close_slice(ctx, &ctx->cpus[c]);
+    }
+    metrics_record_cpus(ctx);
+    instr_collect_heaps(ctx, ctx->scheduling_mode);
+    Evaluation(ctx, algo_name);
+}
+
+void run_scheduler_generic(SimContext* ctx, const char* algo_name, enum SchedulingMode mode,
+                           enum PreemptionMode preemption_mode) {
+    sim_start(ctx, algo_name, mode, preemption_mode);
+    sim_run_until(ctx, algo_name, INT64_MAX);
+    sim_finish(ctx, algo_name);
+}
+
+// Preemption check and dispatch at checkpoint time `now` on the CPUs marked dirty
+void sim_reschedule(SimContext* ctx, int64_t now) {
+    ctx->current_time = now;
+    for (int w = 0; w < CPU_MASK_WORDS; w++) {
+        uint64_t bits = ctx->dirty.bits[w];
+        ctx->dirty.bits[w] = 0;
+        while (bits != 0) {
+            Cpu* cpu = &ctx->cpus[w * 64 + find_first_set(bits)];
+            bits &= bits - 1;
+            ctx->running_count += cpu_schedule(ctx, cpu, now, ctx->scheduling_mode, ctx->preemption_mode);
+        }
+    }
+}
+
+// Continue a run stopped by sim_run_until under another scheduler or policy. Waiting processes
+// move to queues of the new mode in the order the old one would have run them; running ones
+// keep their CPU, start a fresh slice and have their next stop planned again, unless that stop
+// (other than a quantum expiry) is due right now. With the same mode and policy only turning
+// preemption on has an effect, at once; otherwise the run continues exactly as if it had not stopped.
+void sim_change_policy(SimContext* ctx, enum SchedulingMode mode, enum PreemptionMode preemption_mode,
+                       const PolicyConfig* policy) {
+    enum SchedulingMode old_mode = ctx->scheduling_mode;
+    int preemption_on = preemption_mode == PREEMPTIVE && ctx->preemption_mode != PREEMPTIVE;
+    ctx->preemption_mode = preemption_mode;
+    if (mode == old_mode && memcmp(policy, &ctx->policy, sizeof(*policy)) == 0) {
+        if (!preemption_on || ctx->checkpoint_time < 0) return;
+        // Running processes keep their slices; queued ones may preempt them now
+        for (int c = 0; c < ctx->machine.num_cpus; c++) {
+            if (ctx->cpus[c].running != NULL) cpu_mask_set(&ctx->dirty, c);
+        }
+        sim_reschedule(ctx, ctx->checkpoint_time);
+        return;
+    }
+
+    if (ctx->checkpoint_time < 0) return;     // Finished
+    int64_t now = ctx->checkpoint_time;
+    int num_cpus = ctx->machine.num_cpus;
+    ctx->policy = *policy;
+    ctx->scheduling_mode = mode;
+    if (mode == MLFQ_MODE) {
+        int bottom = policy->mlfq.num_levels - 1;
+        for (int i = 0; i < ctx->num_processes; i++) {
+            if (ctx->processes[i].mlfq_level > bottom) ctx->processes[i].mlfq_level = bottom;
+        }
+    }
+    int boost_period = policy->mlfq.boost_period;
+    ctx->next_boost = mode == MLFQ_MODE && boost_period > 0 ? (now / boost_period + 1) * boost_period : INT64_MAX;
+
+    // Every queue is emptied before the priority fields change to the new mode's keys
+    Process** waiting = arena_alloc(&ctx->arena, (size_t)(ctx->num_processes + 1) * sizeof(Process*));
+    int* first_waiting = arena_alloc(&ctx->arena, (size_t)(num_cpus + 1) * sizeof(int));
+    int count = 0;
+    for (int c = 0; c < num_cpus; c++) {
+        ReadyQueue* rq = &ctx->cpus[c].ready_queue;
+        first_waiting[c] = count;
+        while (rq->size != 0) waiting[count++] = ready_queue_pop(rq, old_mode);
+    }
+    first_waiting[num_cpus] = count;
+    if ((realtime_mode(mode) || realtime_mode(old_mode)) && mode != old_mode) process_set_priorities(ctx, mode);
+    if (mode == CFS_MODE && old_mode != CFS_MODE) cfs_reset(ctx);    // Everyone starts level
+    if (share_mode(mode) && !share_mode(old_mode)) share_reset(ctx, 0);
+    if (!share_mode(mode)) ctx->shares = NULL;      // Share accuracy covers lottery and stride only
+
+    int queue_capacity = ctx->num_processes / num_cpus;
+    for (int c = 0; c < num_cpus; c++) {
+        Cpu* cpu = &ctx->cpus[c];
+        ReadyQueue* rq = &cpu->ready_queue;
+        int64_t min_vruntime = rq->cfs.min_vruntime;
+        ready_queue_reset(rq, mode, &ctx->arena, queue_capacity, policy->mlfq.num_levels, ctx->priorities);
+        if (old_mode == CFS_MODE) rq->cfs.min_vruntime = min_vruntime;
+        for (int i = first_waiting[c]; i < first_waiting[c + 1]; i++) ready_queue_push(rq, waiting[i], mode);
+
+        Process* p = cpu->running;
+        if (p == NULL) continue;
+        cpu_mask_set(&ctx->dirty, c);
+        if (p->event_time == now && p->event_type != EVENT_QUANTUM_EXPIRE) continue;
+        wheel_cancel(&ctx->event_wheel, p);
+        p->event_type = EVENT_NONE;
+        if (cpu->run_start < now) {
+            simulate_process_run(p, cpu->run_start, now);
+            if (old_mode == CFS_MODE) {
+                CfsEntity* entity = &ctx->cfs_entities[p - ctx->processes];
+                entity->vruntime += cfs_vtime(now - cpu->run_start, entity->weight);
+            }
+            if (share_mode(old_mode)) {
+                int index = (int)(p - ctx->processes);
+                ctx->stride_passes[index] += (now - cpu->run_start) * (STRIDE_ONE / ctx->tickets[index]);
+            }
+            cpu->busy_time += now - cpu->run_start;
+            // The fresh slice starts a new stint, so its overhead is not counted twice
+            cpu_record_stint(ctx, cpu, p->pid, cpu->run_start, now);
+            cpu->run_start = now;
+            cpu->dispatch_time = now;
+        }
+        schedule_cpu_event(ctx, p, cpu->run_start, mode);
+    }
+
+    // Preemption under the new policy happens now, not at the next event
+    sim_reschedule(ctx, now);
+}
+
+// Fork-based what-if runs. A run stopped at a checkpoint by sim_run_until is forked once per
+// branch: each child process applies its branch's scheduler and policy, runs to the end and
+// sends its metrics back through a pipe. Children share the checkpoint's memory copy-on-write,
+// so a branch only pays for the pages it changes, and any number of branches can start from
+// one prefix.
+typedef struct {
+    int variant;                // Index into scheduler_variants
+    PolicyConfig policy;
+    SimMetrics metrics;         // Result; runs is 0 if the branch failed
+} SimBranch;
+
+int write_all(int fd, const void* data, size_t size) {
+    const char* cursor = data;
+    while (size > 0) {
+        ssize_t written = write(fd, cursor, size);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return -1;
+        cursor += written;
+        size -= (size_t)written;
+    }
+    return 0;
+}
+
+int read_all(int fd, void* data, size_t size) {
+    char* cursor = data;
+    while (size > 0) {
+        ssize_t got = read(fd, cursor, size);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return -1;
+        cursor += got;
+        size -= (size_t)got;
+    }
+    return 0;
+}
+
+// Child side of a branch; never returns
+void sim_branch_child(SimContext* ctx, const SimBranch* branch, int fd) {
+    const SchedulerVariant* variant = &scheduler_variants[branch->variant];
+    ctx->verbose = 0;
+    ctx->trace = NULL;
+    sim_change_policy(ctx, variant->mode, variant->preemption_mode, &branch->policy);
+    sim_run_until(ctx, variant->name, INT64_MAX);
+    sim_finish(ctx, variant->name);
+    _exit(write_all(fd, &ctx->metrics, sizeof(ctx->metrics)) == 0 ? 0 : 1);
+}
+
+// Run every branch from the checkpoint in `ctx`, at most `max_children` at once. The checkpoint
+// itself is left untouched. Returns 0 unless a branch failed.
+int sim_fork_branches(SimContext* ctx, SimBranch* branches, int num_branches, int max_children) {
+    pid_t* children = malloc((size_t)num_branches * sizeof(pid_t));
+    int* pipes = malloc((size_t)num_branches * sizeof(int));
+    if (children == NULL || pipes == NULL) arena_out_of_memory((size_t)num_branches * (sizeof(pid_t) + sizeof(int)));
+    if (max_children < 1) max_children = 1;
+
+    fflush(stdout);     // Children must not write out the parent's buffered output again
+    fflush(stderr);
+    int status = 0;
+    int started = 0, collected = 0;
+    while (collected < num_branches) {
+        if (started < num_branches && started - collected < max_children) {
+            int fds[2];
+            children[started] = -1;
+            pipes[started] = -1;
+            if (pipe(fds) != 0) {
+                fprintf(stderr, "Cannot create a pipe for a branch: %s\n", strerror(errno));
+            } else if ((children[started] = fork()) < 0) {
+                fprintf(stderr, "Cannot fork a branch: %s\n", strerror(errno));
+                close(fds[0]);
+                close(fds[1]);
+            } else if (children[started] == 0) {
+                close(fds[0]);
+                sim_branch_child(ctx, &branches[started], fds[1]);
+            } else {
+                close(fds[1]);
+                pipes[started] = fds[0];
+            }
+            started++;
+            continue;
+        }
+
+        // Collect in start order; a child blocks on its pipe until then
+        SimBranch* branch = &branches[collected];
+        memset(&branch->metrics, 0, sizeof(branch->metrics));
+        int ok = pipes[collected] >= 0 && read_all(pipes[collected], &branch->metrics, sizeof(branch->metrics)) == 0;
+        if (pipes[collected] >= 0) close(pipes[collected]);
+        if (children[collected] > 0) {
+            int exit_status;
+            while (waitpid(children[collected], &exit_status, 0) < 0 && errno == EINTR);
+        }
+        if (!ok) {
+            memset(&branch->metrics, 0, sizeof(branch->metrics));
+            fprintf(stderr, "Branch %s failed\n", scheduler_variants[branch->variant].label);
+            status = -1;
+        }
+        collected++;
+    }
+
+    free(children);
+    free(pipes);
+    return status;
+}
+
+// Specific Schedulers
+void Schedule_FCFS(SimContext* ctx) {
+    run_scheduler_generic(ctx, "FCFS", FCFS_MODE, NON_PREEMPTIVE);
+}
+
+void Schedule_SJF_NonPreemptive(SimContext* ctx) {
+    run_scheduler_generic(ctx, "SJF", SJF_MODE, NON_PREEMPTIVE);
+}
+
+void Schedule_SJF_Preemptive(SimContext* ctx) {
+    run_scheduler_generic(ctx, "SJF", SJF_MODE, PREEMPTIVE);
+}
+
+void Schedule_Priority_NonPreemptive(SimContext* ctx) {
+    run_scheduler_generic(ctx, "Priority", PRIORITY_MODE, NON_PREEMPTIVE);
+}
+
+void Schedule_Priority_Preemptive(SimContext* ctx) {
+    run_scheduler_generic(ctx, "Priority", PRIORITY_MODE, PREEMPTIVE);
+}
+
+void Schedule_RR(SimContext* ctx) {
+    run_scheduler_generic(ctx, "Round Robin", RR_MODE, NON_PREEMPTIVE);
+}
+
+void Schedule_MLFQ(SimContext* ctx) {
+    run_scheduler_generic(ctx, "MLFQ", MLFQ_MODE, PREEMPTIVE);
+}
+
+void Schedule_CFS(SimContext* ctx) {
+    run_scheduler_generic(ctx, "CFS", CFS_MODE, PREEMPTIVE);
+}
+
+// Run one scheduler variant, streaming its trace to `trace_path` if set.
+// Returns 0 unless the trace could not be written.
+int run_variant(SimContext* ctx, int variant_index, const char* trace_path, enum TraceFormat trace_format) {
+    const SchedulerVariant* variant = &scheduler_variants[variant_index];
+    int status = 0;
+    if (trace_path != NULL) {
+        ctx->trace = trace_sink_open(trace_path, trace_format);
+        if (ctx->trace == NULL) status = -1;
+    }
+    run_scheduler_generic(ctx, variant->name, variant->mode, variant->preemption_mode);
+    if (ctx->trace != NULL) {
+        if (ctx->trace->finish(ctx->trace) != 0) {
+            fprintf(stderr, "Failed to write trace file %s\n", trace_path);
+            status = -1;
+        }
+        ctx->trace = NULL;
+    }
+    return status;
+}
+
+// Result cache (--cache DIR): the metrics of each run in a file named after a 128-bit hash of
+// the workload's content, the variant, the settings it uses and the engine version. Entries
+// are written to a temporary file and renamed into place, so concurrent runs never see a
+// partial one, and read through a mapping.
+typedef struct {
+    uint64_t h[2];
+} Digest;
+
+#define RESULT_MAGIC "CPUSRSLT"
+
+typedef struct {
+    char magic[8];
+    uint32_t version;           // SIM_ENGINE_VERSION
+    uint32_t metrics_size;      // sizeof(SimMetrics), which also changes with the byte order
+    Digest key;
+} ResultFileHeader;
+
+void digest_init(Digest* d, uint64_t seed) {
+    d->h[0] = seed ^ 0x243f6a8885a308d3ull;
+    d->h[1] = seed ^ 0x13198a2e03707344ull;
+}
+
+SIM_INLINE void digest_word(Digest* d, uint64_t word) {
+    d->h[0] = rotl64((d->h[0] ^ word) * 0x9e3779b97f4a7c15ull, 31);
+    d->h[1] = rotl64((d->h[1] + word) * 0xc2b2ae3d27d4eb4full, 29) ^ d->h[0];
+}
+
+void digest_bytes(Digest* d, const void* data, size_t size) {
+    const unsigned char* bytes = data;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        digest_word(d, word);
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, bytes + i, size - i);
+    digest_word(d, tail);
+    digest_word(d, size);
+}
+
+void digest_distribution(Digest* d, const Distribution* dist) {
+    uint64_t a, b;
+    memcpy(&a, &dist->a, 8);
+    memcpy(&b, &dist->b, 8);
+    digest_word(d, dist->kind);
+    digest_word(d, a);
+    digest_word(d, b);
+}
+
+// Everything of a workload that can change a run's results
+void workload_digest(const Workload* workload, Digest* d) {
+    digest_init(d, 0);
+    digest_bytes(d, workload->records, (size_t)workload->count * sizeof(WorkloadRecord));
+    digest_bytes(d, workload->io_operations, workload->num_io_operations * sizeof(IOOperation));
+    digest_word(d, workload->affinity != NULL);
+    if (workload->affinity != NULL) {
+        digest_bytes(d, workload->affinity, (size_t)workload->count * sizeof(CpuMask));
+    }
+    digest_word(d, workload->realtime != NULL);
+    if (workload->realtime != NULL) {
+        digest_bytes(d, workload->realtime, (size_t)workload->count * sizeof(RealtimeRecord));
+    }
+    digest_word(d, workload->shares != NULL);
+    if (workload->shares != NULL) digest_bytes(d, workload->shares, (size_t)workload->count * sizeof(int));
+    digest_word(d, workload->phases != NULL);
+    if (workload->phases != NULL) {
+        digest_word(d, workload->phases->seed);
+        digest_distribution(d, &workload->phases->cpu);
+        digest_distribution(d, &workload->phases->io);
+    }
+}
+
+// Key of a run: settings the variant does not use are left out, so e.g. FCFS results
+// survive a quantum change
+void result_cache_key(const Digest* workload, int variant_index, const PolicyConfig* policy,
+                      const MachineConfig* machine, Digest* key) {
+    const SchedulerVariant* variant = &scheduler_variants[variant_index];
+    digest_init(key, SIM_ENGINE_VERSION);
+    digest_word(key, workload->h[0]);
+    digest_word(key, workload->h[1]);
+    digest_bytes(key, variant->key, strlen(variant->key));
+    digest_word(key, SIM_INSTRUMENT);
+    digest_word(key, sizeof(SimMetrics));
+    digest_word(key, (uint64_t)machine->num_cpus << 32 | (uint32_t)machine->migration_cost);
+    digest_word(key, (uint64_t)machine->dispatch_cost << 32 | (uint32_t)machine->preemption_cost);
+    digest_word(key, (uint64_t)machine->refill_cost << 32 | (uint32_t)machine->refill_time);
+    if (variant->mode == RR_MODE) digest_word(key, (uint64_t)policy->time_quantum);
+    if (variant->mode == MLFQ_MODE) {
+        digest_bytes(key, policy->mlfq.quanta, (size_t)policy->mlfq.num_levels * sizeof(int));
+        digest_word(key, (uint64_t)policy->mlfq.boost_period);
+    }
+    if (variant->mode == CFS_MODE) {
+        digest_word(key, (uint64_t)policy->cfs.target_latency << 32 | (uint32_t)policy->cfs.min_granularity);
+    }
+    if (share_mode(variant->mode)) {
+        digest_word(key, (uint64_t)policy->time_quantum << 32 | (uint32_t)policy->share.window);
+        if (variant->mode == LOTTERY_MODE) digest_word(key, policy->share.seed);
+    }
+    for (int i = 0; i < 2; i++) {
+        uint64_t state = key->h[i] ^ key->h[1 - i];
+        key->h[i] = splitmix64(&state);
+    }
+}
+
+void result_cache_path(const char* dir, const Digest* key, char* out, size_t size) {
+    snprintf(out, size, "%s/%016llx%016llx.res", dir, (unsigned long long)key->h[0], (unsigned long long)key->h[1]);
+}
+
+// Returns 0 and fills `metrics` on a hit
+int result_cache_load(const char* dir, const Digest* key, SimMetrics* metrics) {
+    char path[PATH_MAX];
+    result_cache_path(dir, key, path, sizeof(path));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    size_t size = sizeof(ResultFileHeader) + sizeof(SimMetrics);
+    struct stat st;
+    int status = -1;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size == size) {
+        void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            const ResultFileHeader* header = mapping;
+            if (memcmp(header->magic, RESULT_MAGIC, 8) == 0 && header->version == SIM_ENGINE_VERSION &&
+                header->metrics_size == sizeof(SimMetrics) && memcmp(&header->key, key, sizeof(Digest)) == 0) {
+                memcpy(metrics, header + 1, sizeof(SimMetrics));
+                status = 0;
+            }
+            munmap(mapping, size);
+        }
+    }
+    close(fd);
+    return status;
+}
+
+// Returns 0 on success
+int result_cache_store(const char* dir, const Digest* key, const SimMetrics* metrics) {
+    char path[PATH_MAX], temp[PATH_MAX + 8];
+    result_cache_path(dir, key, path, sizeof(path));
+    snprintf(temp, sizeof(temp), "%s.XXXXXX", path);
+    int fd = mkstemp(temp);
+    if (fd < 0) return -1;
+
+    ResultFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RESULT_MAGIC, 8);
+    header.version = SIM_ENGINE_VERSION;
+    header.metrics_size = sizeof(SimMetrics);
+    header.key = *key;
+    int status = fchmod(fd, 0644) == 0 && write_all(fd, &header, sizeof(header)) == 0 &&
+                 write_all(fd, metrics, sizeof(*metrics)) == 0 ? 0 : -1;
+    if (close(fd) != 0) status = -1;
+    if (status == 0 && rename(temp, path) != 0) status = -1;
+    if (status != 0) unlink(temp);
+    return status;
+}
+
+// Batch runner: a pool of worker threads, each with its own SimContext, pulls
+// (workload, scheduler variant) jobs from a shared queue. Workers merge their results
+// per variant locally and into the shared totals once at the end.
+typedef struct {
+    const Workload* workload;
+    int variant;                // Index into scheduler_variants
+    PolicyConfig policy;
+    MachineConfig machine;
+    const char* trace_path;     // NULL: no trace
+    enum TraceFormat trace_format;
+    int trace_status;           // Result of run_variant
+    SimMetrics* result;         // If set, receives this job's metrics
+    const char* cache_dir;      // Result cache, NULL: none. Runs with a trace are always simulated.
+    Digest workload_digest;     // workload_digest() of the workload, set with cache_dir
+    int cache_hit;
+} BatchJob;
+
+typedef struct {
+    BatchJob* jobs;
+    int num_jobs;
+    int next_job;
+    SimMetrics* merged;         // Per variant
+    pthread_mutex_t lock;
+} BatchQueue;
+
+void* batch_worker(void* arg) {
+    BatchQueue* queue = arg;
+    SimContext ctx;
+    sim_context_init(&ctx, NULL);
+    ctx.verbose = 0;
+    SimMetrics* local = calloc(NUM_SCHEDULER_VARIANTS, sizeof(SimMetrics));
+    if (local == NULL) arena_out_of_memory(NUM_SCHEDULER_VARIANTS * sizeof(SimMetrics));
+
+    while (1) {
+        pthread_mutex_lock(&queue->lock);
+        int index = queue->next_job++;
+        pthread_mutex_unlock(&queue->lock);
+        if (index >= queue->num_jobs) break;
+
+        BatchJob* job = &queue->jobs[index];
+        ctx.workload = job->workload;
+        ctx.policy = job->policy;
+        ctx.machine = job->machine;
+        Digest key;
+        if (job->cache_dir != NULL) {
+            result_cache_key(&job->workload_digest, job->variant, &job->policy, &job->machine, &key);
+        }
+        if (job->cache_dir != NULL && job->trace_path == NULL &&
+            result_cache_load(job->cache_dir, &key, &ctx.metrics) == 0) {
+            job->cache_hit = 1;
+        } else {
+            job->trace_status = run_variant(&ctx, job->variant, job->trace_path, job->trace_format);
+            if (job->cache_dir != NULL && result_cache_store(job->cache_dir, &key, &ctx.metrics) != 0) {
+                fprintf(stderr, "Failed to write to the result cache %s\n", job->cache_dir);
+            }
+        }
+        metrics_merge(&local[job->variant], &ctx.metrics);
+        if (job->result != NULL) *job->result = ctx.metrics;
+    }
+
+    pthread_mutex_lock(&queue->lock);
+    for (int v = 0; v < NUM_SCHEDULER_VARIANTS; v++) {
+        metrics_merge(&queue->merged[v], &local[v]);
+    }
+    pthread_mutex_unlock(&queue->lock);
+
+    free(local);
+    sim_context_free(&ctx);
+    return NULL;
+}
+
+int default_thread_count() {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int)cores : 1;
+}
+
+// Run all jobs on `num_threads` workers; metrics are merged per variant into `merged`
+void run_batch(BatchJob* jobs, int num_jobs, int num_threads, SimMetrics merged[NUM_SCHEDULER_VARIANTS]) {
+    BatchQueue queue;
+    queue.jobs = jobs;
+    queue.num_jobs = num_jobs;
+    queue.next_job = 0;
+    queue.merged = merged;
+    memset(merged, 0, NUM_SCHEDULER_VARIANTS * sizeof(SimMetrics));
+    pthread_mutex_init(&queue.lock, NULL);
+
+    if (num_threads > num_jobs) num_threads = num_jobs;
+    if (num_threads < 1) num_threads = 1;
+
+    pthread_t* threads = malloc((size_t)num_threads * sizeof(pthread_t));
+    if (threads == NULL) arena_out_of_memory((size_t)num_threads * sizeof(pthread_t));
+
+    int started = 0;
+    for (int i = 0; i < num_threads; i++) {
+        if (pthread_create(&threads[i], NULL, batch_worker, &queue) != 0) break;
+        started++;
+    }
+    if (started == 0) {
+        batch_worker(&queue);   // No threads available: run everything here
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    free(threads);
+    pthread_mutex_destroy(&queue.lock);
+}
+
+// Run the selected scheduler variants (all if `selected` is NULL) on every workload and
+// merge the metrics per variant. `trace_paths` (per variant, may be NULL) is only meant for
+// a single workload; `cache_dir` (may be NULL) reuses and keeps results. Returns 0 unless a
+// trace could not be written.
+int run_batch_comparison(const Workload* workloads, int num_workloads, const int* selected,
+                         const PolicyConfig* policy, const MachineConfig* machine, int num_threads, const char* const* trace_paths, enum TraceFormat trace_format,
+                         const char* cache_dir, SimMetrics merged[NUM_SCHEDULER_VARIANTS]) {
+    BatchJob* jobs = calloc((size_t)num_workloads * NUM_SCHEDULER_VARIANTS, sizeof(BatchJob));
+    if (jobs == NULL) arena_out_of_memory((size_t)num_workloads * NUM_SCHEDULER_VARIANTS * sizeof(BatchJob));
+
+    int num_jobs = 0;
+    for (int w = 0; w < num_workloads; w++) {
+        Digest digest = {{0, 0}};
+        if (cache_dir != NULL) workload_digest(&workloads[w], &digest);
+        for (int v = 0; v < NUM_SCHEDULER_VARIANTS; v++) {
+            if (selected != NULL && !selected[v]) continue;
+            jobs[num_jobs].workload = &workloads[w];
+            jobs[num_jobs].variant = v;
+            jobs[num_jobs].policy = *policy;
+            jobs[num_jobs].machine = *machine;
+            jobs[num_jobs].trace_path = trace_paths != NULL ? trace_paths[v] : NULL;
+            jobs[num_jobs].trace_format = trace_format;
+            jobs[num_jobs].cache_dir = cache_dir;
+            jobs[num_jobs].workload_digest = digest;
+            num_jobs++;
+        }
+    }
+
+    run_batch(jobs, num_jobs, num_threads, merged);
+
+    int status = 0, hits = 0;
+    for (int i = 0; i < num_jobs; i++) {
+        if (jobs[i].trace_status != 0) status = -1;
+        hits += jobs[i].cache_hit;
+    }
+    if (cache_dir != NULL) fprintf(stderr, "Result cache: %d of %d runs reused\n", hits, num_jobs);
+    free(jobs);
+    return status;
+}
+
+// What-if comparison: run variant `base` up to time `fork_at`, then finish the run once per
+// selected variant from there. `*checkpoint` is set to `fork_at`, or -1 if the run was over before. Returns 0 unless a branch failed.
+int run_fork_comparison(const Workload* workload, int base, int64_t fork_at, const int* selected,
+                        const PolicyConfig* policy, const MachineConfig* machine, int num_threads,
+                        SimMetrics merged[NUM_SCHEDULER_VARIANTS], int64_t* checkpoint) {
+    SimContext ctx;
+    sim_context_init(&ctx, workload);
+    ctx.verbose = 0;
+    ctx.policy = *policy;
+    ctx.machine = *machine;
+    const SchedulerVariant* variant = &scheduler_variants[base];
+    sim_start(&ctx, variant->name, variant->mode, variant->preemption_mode);
+    int finished = sim_run_until(&ctx, variant->name, fork_at);
+    *checkpoint = finished ? -1 : ctx.checkpoint_time;
+
+    SimBranch* branches = calloc(NUM_SCHEDULER_VARIANTS, sizeof(SimBranch));
+    if (branches == NULL) arena_out_of_memory(NUM_SCHEDULER_VARIANTS * sizeof(SimBranch));
+    int num_branches = 0;
+    for (int v = 0; v < NUM_SCHEDULER_VARIANTS; v++) {
+        if (selected != NULL && !selected[v]) continue;
+        branches[num_branches].variant = v;
+        branches[num_branches].policy = *policy;
+        num_branches++;
+    }
+    int status = sim_fork_branches(&ctx, branches, num_branches, num_threads);
+
+    memset(merged, 0, NUM_SCHEDULER_VARIANTS * sizeof(SimMetrics));
+    for (int i = 0; i < num_branches; i++) {
+        merged[branches[i].variant] = branches[i].metrics;
+    }
+    free(branches);
+    sim_context_free(&ctx);
+    return status;
+}
+
+// Share of the CPU time available during the runs that was spent running processes (the effective
+// utilization: switch, cache refill and migration overhead does not count)
+double metrics_utilization(const SimMetrics* m) {
+    double capacity = m->total_makespan * (m->num_cpus > 0 ? m->num_cpus : 1);
+    return m->total_busy_time / (capacity > 0 ? capacity : 1);
+}
+
+// Share of the CPU time available during the runs that went to overhead
+double metrics_overhead_fraction(const SimMetrics* m) {
+    double capacity = m->total_makespan * (m->num_cpus > 0 ? m->num_cpus : 1);
+    return m->total_overhead_time / (capacity > 0 ? capacity : 1);
+}
+
+// Variants without runs are skipped; runs with overhead add an overhead column, runs with
+// deadlines miss ratio and lateness columns, multiprocessor runs migration and load imbalance columns
+void print_batch_results(const SimMetrics merged[NUM_SCHEDULER_VARIANTS]) {
+    int smp = 0, overhead = 0, deadlines = 0, shares = 0;
+    for (int v = 0; v < NUM_SCHEDULER_VARIANTS; v++) {
+        if (merged[v].num_cpus > 1) smp = 1;
+        if (merged[v].total_overhead_time > 0) overhead = 1;
+        if (merged[v].deadline_processes > 0) deadlines = 1;
+        if (merged[v].share_windows > 0) shares = 1;
+    }
+    printf("\nAlgorithm                 | Runs | Avg Waiting | p99 Waiting | Avg Turnaround | p99 Turnaround "
+           "| Avg Response | p99 Response | Avg Makespan | Util %% | Switches/Run%s%s%s%s\n",
+           overhead ? " | Overhead %" : "", deadlines ? " | Missed % | p99 Lateness | Max Lateness" : "",
+           shares ? " | Share Err % | p99 Share Dev" : "", smp ? " | Migrations/Run | Imbalance %" : "");
+    printf("--------------------------|------|-------------|-------------|----------------|---------------"
+           "-|--------------|--------------|--------------|--------|-------------%s%s%s%s\n",
+           overhead ? "|-----------" : "", deadlines ? "|----------|--------------|-------------" : "",
+           shares ? "|-------------|--------------" : "", smp ? "|----------------|------------" : "");
+    for (int v = 0; v < NUM_SCHEDULER_VARIANTS; v++) {
+        const SimMetrics* m = &merged[v];
+        if (m->runs == 0) continue;
+        printf("%-25s | %4d | %11.2f | %11.0f | %14.2f | %14.0f | %12.2f | %12.0f | %12.2f | %6.2f | %12.1f",
+               scheduler_variants[v].label, m->runs,
+               stats_mean(&m->waiting.stats), distribution_quantile(&m->waiting, 0.99),
+               stats_mean(&m->turnaround.stats), distribution_quantile(&m->turnaround, 0.99),
+               stats_mean(&m->response.stats), distribution_quantile(&m->response, 0.99),
+               m->total_makespan / m->runs, 100.0 * metrics_utilization(m),
+               (double)m->context_switches / m->runs);
+        if (overhead) printf(" | %10.2f", 100.0 * metrics_overhead_fraction(m));
+        if (deadlines) {
+            printf(" | %8.2f | %12.0f | %12lld", 100.0 * metrics_miss_ratio(m), distribution_quantile(&m->lateness, 0.99),
+                   (long long)m->lateness.stats.max);
+        }
+        if (shares) {
+            if (m->share_windows > 0) {
+                printf(" | %11.2f | %13.0f", 100.0 * metrics_share_error(m),
+                       distribution_quantile(&m->share_deviation, 0.99));
+            } else {
+                printf(" | %11s | %13s", "-", "-");
+            }
+        }
+        if (smp) {
+            printf(" | %14.1f | %10.2f", (double)m->migrations / m->runs, 100.0 * m->total_imbalance / m->runs);
+        }
+        printf("\n");
+    }
+}
+
+void print_distribution_csv(const LatencyDistribution* distribution) {
+    printf(",%.4f,%.4f,%.0f,%.0f,%.0f,%lld",
+           stats_mean(&distribution->stats), stats_stddev(&distribution->stats),
+           distribution_quantile(distribution, 0.50), distribution_quantile(distribution, 0.95),
+           distribution_quantile(distribution, 0.99), (long long)distribution->stats.max);
+}
+
+void print_batch_results_csv(const SimMetrics merged[NUM_SCHEDULER_VARIANTS]) {
+    printf("algorithm,runs,processes,completed");
+    static const char* const distributions[] = {"waiting", "turnaround", "response"};
+    for (int d = 0; d < 3; d++) {
+        printf(",avg_%s,stddev_%s,p50_%s,p95_%s,p99_%s,max_%s", distributions[d], distributions[d],
+               distributions[d], distributions[d], distributions[d], distributions[d]);
+    }
+    printf(",avg_makespan,utilization,throughput,context_switches,peak_memory_kb,cpus,migrations,steals,load_imbalance"
+           ",preemptions,cache_refills,overhead_time,overhead_fraction,deadline_processes,deadline_misses,miss_ratio");
+    printf(",avg_lateness,stddev_lateness,p50_lateness,p95_lateness,p99_lateness,max_lateness");
+    printf(",share_windows,share_error,avg_share_deviation,stddev_share_deviation,p50_share_deviation"
+           ",p95_share_deviation,p99_share_deviation,max_share_deviation\n");
+
+    for (int v = 0; v < NUM_SCHEDULER_VARIANTS; v++) {
+        const SimMetrics* m = &merged[v];
+        if (m->runs == 0) continue;
+        double makespan = m->total_makespan > 0 ? m->total_makespan : 1;
+        printf("%s,%d,%d,%d", scheduler_variants[v].label, m->runs, m->num_processes, m->completed_count);
+        print_distribution_csv(&m->waiting);
+        print_distribution_csv(&m->turnaround);
+        print_distribution_csv(&m->response);
+        printf(",%.4f,%.4f,%.6f,%llu,%.1f,%d,%llu,%llu,%.4f,%llu,%llu,%.0f,%.4f,%llu,%llu,%.4f", m->total_makespan / m->runs,
+               metrics_utilization(m), m->completed_count / makespan, (unsigned long long)m->context_switches,
+               m->peak_memory / 1024.0, m->num_cpus, (unsigned long long)m->migrations,
+               (unsigned long long)m->steals, m->total_imbalance / m->runs, (unsigned long long)m->preemptions,
+               (unsigned long long)m->cache_refills, m->total_overhead_time, metrics_overhead_fraction(m),
+               (unsigned long long)m->deadline_processes, (unsigned long long)m->deadline_misses,
+               metrics_miss_ratio(m));
+        print_distribution_csv(&m->lateness);
+        printf(",%llu,%.4f", (unsigned long long)m->share_windows, metrics_share_error(m));
+        print_distribution_csv(&m->share_deviation);
+        printf("\n");
+    }
+}
+
+void Batch_Comparison(const Workload* current) {
+    int num_workloads;
+    int num_per_workload = 0;
+    int num_threads;
+
+    printf("Enter number of random workloads (0 = current processes only): ");
+    if (scanf("%d", &num_workloads) != 1 || num_workloads < 0) {
+        printf("Invalid number of workloads. Setting to default 0.\n");
+        num_workloads = 0;
+        while (getchar() != '\n');
+    }
+    if (num_workloads == 0 && current->count == 0) {
+        printf("Please create processes first (Option 1)\n");
+        return;
+    }
+    if (num_workloads > 0) {
+        printf("Enter number of processes per workload (e.g., 5): ");
+        if (scanf("%d", &num_per_workload) != 1 || num_per_workload <= 0) {
+            printf("Invalid number of processes. Setting to default 5.\n");
+            num_per_workload = 5;
+            while (getchar() != '\n');
+        }
+    }
+    printf("Enter number of worker threads (0 = all cores): ");
+    if (scanf("%d", &num_threads) != 1 || num_threads < 0) {
+        num_threads = 0;
+        while (getchar() != '\n');
+    }
+    if (num_threads == 0) num_threads = default_thread_count();
+
+    Workload* workloads = NULL;
+    const Workload* batch = current;
+    int batch_size = 1;
+    if (num_workloads > 0) {
+        workloads = calloc((size_t)num_workloads, sizeof(Workload));
+        if (workloads == NULL) arena_out_of_memory((size_t)num_workloads * sizeof(Workload));
+        uint64_t base_seed = (uint64_t)time(NULL);
+        for (int w = 0; w < num_workloads; w++) {
+            generate_random_workload(&workloads[w], num_per_workload, base_seed + (uint64_t)w);
+        }
+        batch = workloads;
+        batch_size = num_workloads;
+    }
+
+    // Random workloads have no deadlines for EDF and RM
+    int selected[NUM_SCHEDULER_VARIANTS];
+    int num_selected = 0;
+    for (int v = 0; v < NUM_SCHEDULER_VARIANTS; v++) {
+        selected[v] = !realtime_mode(scheduler_variants[v].mode);
+        num_selected += selected[v];
+    }
+    SimMetrics merged[NUM_SCHEDULER_VARIANTS];
+    MachineConfig uniprocessor = {1, 0, 0, 0, 0, 0};
+    PolicyConfig policy;
+    policy_defaults(&policy);
+    run_batch_comparison(batch, batch_size, selected, &policy, &uniprocessor, num_threads, NULL,
+                         TRACE_FORMAT_BINARY, NULL, merged);
+
+    printf("\n--- Batch Results: %d workload(s) x %d algorithms, %d thread(s) ---\n",
+           batch_size, num_selected, num_threads);
+    print_batch_results(merged);
+
+    if (workloads != NULL) {
+        for (int w = 0; w < num_workloads; w++) {
+            workload_free(&workloads[w]);
+        }
+        free(workloads);
+    }
+}
+
+// Engine counters per variant as JSON; `path` "-" writes to stdout. Returns 0 on success.
+int write_counters_json(const char* path, const SimMetrics merged[NUM_SCHEDULER_VARIANTS]) {
+    FILE* file = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot create %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    fprintf(file, "{\"instrumentation\": %d, \"variants\": {", SIM_INSTRUMENT);
+    int first = 1;
+    for (int v = 0; v < NUM_SCHEDULER_VARIANTS; v++) {
+        const SimMetrics* m = &merged[v];
+        const InstrCounters* instr = &m->instr;
+        if (m->runs == 0) continue;
+        fprintf(file, "%s\n  \"%s\": {\"runs\": %d, \"events\": %llu, \"dispatches\": %llu, "
+                "\"heap_inserts\": %llu, \"heap_extracts\": %llu, \"heap_removes\": %llu, "
+                "\"comparator_calls\": %llu, \"preemptions\": %llu, \"quantum_expiries\": %llu, \"mlfq_boosts\": %llu, "
+                "\"io_requests\": %llu, \"io_completions\": %llu, \"idle_fast_forwards\": %llu, "
+                "\"gantt_coalesces\": %llu, \"wheel_cascades\": %llu, \"cfs_rotations\": %llu, "
+                "\"migrations\": %llu, \"steals\": %llu, "
+                "\"phase_ns\": {",
+                first ? "" : ",", scheduler_variants[v].key, m->runs,
+                (unsigned long long)m->events, (unsigned long long)m->dispatches,
+                (unsigned long long)instr->heap.inserts, (unsigned long long)instr->heap.extracts,
+                (unsigned long long)instr->heap.removes, (unsigned long long)instr->heap.compares,
+                (unsigned long long)instr->preemptions, (unsigned long long)instr->quantum_expiries,
+                (unsigned long long)instr->mlfq_boosts,
+                (unsigned long long)instr->io_requests, (unsigned long long)instr->io_completions,
+                (unsigned long long)instr->idle_fast_forwards, (unsigned long long)instr->gantt_coalesces,
+                (unsigned long long)instr->wheel_cascades, (unsigned long long)instr->cfs_rotations,
+                (unsigned long long)m->migrations, (unsigned long long)m->steals);
+        for (int phase = 0; phase < NUM_SIM_PHASES; phase++) {
+            fprintf(file, "%s\"%s\": %llu", phase == 0 ? "" : ", ", sim_phase_names[phase],
+                    (unsigned long long)instr->phase_ns[phase]);
+        }
+        fprintf(file, "}}");
+        first = 0;
+    }
+    fprintf(file, "\n}}\n");
+    if (file == stdout) return 0;
+    if (fclose(file) != 0) {
+        fprintf(stderr, "Failed to write %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// Benchmark mode: time each selected scheduler variant on generated workloads of growing size
+// and I/O density, one run at a time on this thread
+#define BENCH_MAX_POINTS 16
+#define BENCH_MIN_SECONDS 0.1   // Short points repeat until they have run this long in total
+#define BENCH_MAX_REPEAT 1000
+
+typedef struct {
+    int sizes[BENCH_MAX_POINTS];        // Processes per workload
+    int num_sizes;
+    int io_counts[BENCH_MAX_POINTS];    // I/O operations per process
+    int num_io_counts;
+    int repeat;                         // Runs per point; the fastest counts
+    double budget;                      // Remaining points are skipped once a run takes longer (seconds)
+    uint64_t seed;
+    int num_threads;                    // Workload generation threads
+    const char* output_path;            // CSV results
+    const char* baseline_path;          // Earlier CSV results to compare against
+    double tolerance;                   // Allowed slowdown against the baseline, percent
+} BenchOptions;
+
+typedef struct {
+    int variant;
+    int processes;
+    int io_count;
+    uint64_t events;
+    uint64_t dispatches;
+    double seconds;
+    double events_per_sec;
+    double ns_per_dispatch;
+    long peak_rss_kb;                   // Whole process, high-water mark so far
+    size_t sim_memory;                  // Workload + simulation arena of this run
+} BenchResult;
+
+double monotonic_seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+long peak_rss_kb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return usage.ru_maxrss;    // Kilobytes on Linux
+}
+
+// Comma-separated integers in [min_value, max_value]. Returns the count, or -1 on error.
+int parse_int_list(const char* text, int* values, int max_values, int min_value, int max_value) {
+    int count = 0;
+    const char* cursor = text;
+    while (*cursor != '\0') {
+        char* end;
+        long value = strtol(cursor, &end, 10);
+        if (end == cursor || value < min_value || value > max_value || count >= max_values ||
+            (*end != ',' && *end != '\0')) {
+            return -1;
+        }
+        values[count++] = (int)value;
+        cursor = *end == ',' ? end + 1 : end;
+    }
+    return count;
+}
+
+int variant_by_key(const char* key) {
+    for (int v = 0; v < NUM_SCHEDULER_VARIANTS; v++) {
+        if (strcmp(scheduler_variants[v].key, key) == 0) return v;
+    }
+    return -1;
+}
+
+#define BENCH_CSV_HEADER "variant,processes,io_per_process,events,dispatches,seconds,events_per_sec,ns_per_dispatch,peak_rss_kb,sim_memory_kb"
+
+int write_bench_results(const char* path, const BenchResult* results, int num_results) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot create %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    fprintf(file, "%s\n", BENCH_CSV_HEADER);
+    for (int i = 0; i < num_results; i++) {
+        const BenchResult* r = &results[i];
+        fprintf(file, "%s,%d,%d,%llu,%llu,%.6f,%.1f,%.2f,%ld,%.1f\n",
+                scheduler_variants[r->variant].key, r->processes, r->io_count,
+                (unsigned long long)r->events, (unsigned long long)r->dispatches, r->seconds,
+                r->events_per_sec, r->ns_per_dispatch, r->peak_rss_kb, r->sim_memory / 1024.0);
+    }
+    if (fclose(file) != 0) {
+        fprintf(stderr, "Failed to write %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// Load results written by write_bench_results; returns the count or -1
+int read_bench_results(const char* path, BenchResult** results) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot open baseline %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    int capacity = 64, count = 0;
+    BenchResult* loaded = malloc((size_t)capacity * sizeof(BenchResult));
+    if (loaded == NULL) arena_out_of_memory((size_t)capacity * sizeof(BenchResult));
+
+    char line[512];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char key[32];
+        BenchResult r;
+        unsigned long long events, dispatches;
+        double sim_memory_kb;
+        memset(&r, 0, sizeof(r));
+        if (sscanf(line, "%31[^,],%d,%d,%llu,%llu,%lf,%lf,%lf,%ld,%lf", key, &r.processes, &r.io_count,
+                   &events, &dispatches, &r.seconds, &r.events_per_sec, &r.ns_per_dispatch,
+                   &r.peak_rss_kb, &sim_memory_kb) != 10) {
+            continue;   // Header or foreign line
+        }
+        r.variant = variant_by_key(key);
+        if (r.variant < 0) continue;
+        r.events = events;
+        r.dispatches = dispatches;
+        r.sim_memory = (size_t)(sim_memory_kb * 1024.0);
+        if (count >= capacity) {
+            capacity *= 2;
+            loaded = realloc(loaded, (size_t)capacity * sizeof(BenchResult));
+            if (loaded == NULL) arena_out_of_memory((size_t)capacity * sizeof(BenchResult));
+        }
+        loaded[count++] = r;
+    }
+    fclose(file);
+    *results = loaded;
+    return count;
+}
+
+// Print the change against the baseline per point; returns the number of regressions
+int compare_bench_results(const BenchResult* results, int num_results, const BenchResult* baseline,
+                          int num_baseline, double tolerance) {
+    int regressions = 0, compared = 0;
+    printf("\n--- Baseline comparison (tolerance %.1f%%) ---\n", tolerance);
+    printf("Variant    | Processes | I/O | Baseline ev/s |  Current ev/s | Change\n");
+    printf("-----------|-----------|-----|---------------|---------------|--------\n");
+    for (int i = 0; i < num_results; i++) {
+        const BenchResult* r = &results[i];
+        const BenchResult* b = NULL;
+        for (int j = 0; j < num_baseline; j++) {
+            if (baseline[j].variant == r->variant && baseline[j].processes == r->processes &&
+                baseline[j].io_count == r->io_count) {
+                b = &baseline[j];
+                break;
+            }
+        }
+        if (b == NULL || b->events_per_sec <= 0) continue;
+
+        double change = 100.0 * (r->events_per_sec / b->events_per_sec - 1.0);
+        int regressed = change < -tolerance;
+        regressions += regressed;
+        compared++;
+        printf("%-10s | %9d | %3d | %13.0f | %13.0f | %+6.1f%%%s\n", scheduler_variants[r->variant].key,
+               r->processes, r->io_count, b->events_per_sec, r->events_per_sec, change,
+               regressed ? "  REGRESSION" : "");
+        if (b->events != r->events) {
+            printf("           (event count differs from the baseline: %llu vs %llu)\n",
+                   (unsigned long long)r->events, (unsigned long long)b->events);
+        }
+    }
+    printf("%d point(s) compared, %d regression(s)\n", compared, regressions);
+    return regressions;
+}
+
+// Returns the process exit status
+int run_benchmark(const BenchOptions* options, const int selected[NUM_SCHEDULER_VARIANTS],
+                  const PolicyConfig* policy, const MachineConfig* machine) {
+    int max_results = options->num_sizes * options->num_io_counts * NUM_SCHEDULER_VARIANTS;
+    BenchResult* results = calloc((size_t)max_results, sizeof(BenchResult));
+    if (results == NULL) arena_out_of_memory((size_t)max_results * sizeof(BenchResult));
+    int num_results = 0;
+
+    SimContext ctx;
+    sim_context_init(&ctx, NULL);
+    ctx.verbose = 0;
+    ctx.policy = *policy;
+    ctx.machine = *machine;
+
+    if (machine->num_cpus > 1) printf("%d CPUs, migration cost %d\n", machine->num_cpus, machine->migration_cost);
+    printf("Variant    | Processes | I/O |     Events |  Dispatches | Best (s) |      Events/s | ns/Dispatch | Peak RSS (KB)\n");
+    printf("-----------|-----------|-----|------------|-------------|----------|---------------|-------------|--------------\n");
+    int over_budget = 0;
+    for (int s = 0; s < options->num_sizes && !over_budget; s++) {
+        for (int d = 0; d < options->num_io_counts && !over_budget; d++) {
+            Workload workload = {0};
+            generate_benchmark_workload(&workload, options->sizes[s], options->io_counts[d], options->seed,
+                                        options->num_threads);
+            ctx.workload = &workload;
+
+            for (int v = 0; v < NUM_SCHEDULER_VARIANTS && !over_budget; v++) {
+                if (!selected[v]) continue;
+                BenchResult* r = &results[num_results++];
+                r->variant = v;
+                r->processes = options->sizes[s];
+                r->io_count = options->io_counts[d];
+
+                double total = 0;
+                for (int rep = 0; rep < options->repeat || (total < BENCH_MIN_SECONDS && rep < BENCH_MAX_REPEAT); rep++) {
+                    double start = monotonic_seconds();
+                    run_variant(&ctx, v, NULL, TRACE_FORMAT_BINARY);
+                    double seconds = monotonic_seconds() - start;
+                    total += seconds;
+                    if (rep == 0 || seconds < r->seconds) r->seconds = seconds;
+                    if (seconds > options->budget) over_budget = 1;
+                    if (seconds > 1.0) break;   // Long runs are stable enough
+                }
+                r->events = ctx.metrics.events;
+                r->dispatches = ctx.metrics.dispatches;
+                r->events_per_sec = r->seconds > 0 ? r->events / r->seconds : 0;
+                r->ns_per_dispatch = r->dispatches > 0 ? r->seconds * 1e9 / r->dispatches : 0;
+                r->peak_rss_kb = peak_rss_kb();
+                r->sim_memory = ctx.metrics.peak_memory;
 
-// Comparison functions for different scheduling algorithms
-int compare_fcfs(Process* a, Process* b) {
-    if (a->arrival_time != b->arrival_time) {
-        return a->arrival_time - b->arrival_time; // Earlier arrival has higher priority
+                printf("%-10s | %9d | %3d | %10llu | %11llu | %8.4f | %13.0f | %11.1f | %13ld\n",
+                       scheduler_variants[v].key, r->processes, r->io_count,
+                       (unsigned long long)r->events, (unsigned long long)r->dispatches, r->seconds,
+                       r->events_per_sec, r->ns_per_dispatch, r->peak_rss_kb);
+                fflush(stdout);
+            }
+            workload_free(&workload);
+        }
+    }
+    sim_context_free(&ctx);
+    if (over_budget && num_results < max_results) {
+        printf("Remaining points skipped: a run took longer than %.0f s (--bench-budget)\n", options->budget);
     }
-    return a->pid - b->pid; // Tie-break by PID
-}
 
-int compare_sjf(Process* a, Process* b) {
-    if (a->remaining_cpu_total != b->remaining_cpu_total) {
-        return a->remaining_cpu_total - b->remaining_cpu_total; // Shorter job has higher priority
+    int status = 0;
+    if (options->output_path != NULL && write_bench_results(options->output_path, results, num_results) != 0) {
+        status = 1;
     }
-    if (a->arrival_time != b->arrival_time) {
-        return a->arrival_time - b->arrival_time; // Earlier arrival breaks tie
+    if (options->baseline_path != NULL) {
+        BenchResult* baseline = NULL;
+        int num_baseline = read_bench_results(options->baseline_path, &baseline);
+        if (num_baseline < 0) {
+            status = 1;
+        } else {
+            if (compare_bench_results(results, num_results, baseline, num_baseline, options->tolerance) > 0) {
+                status = 2;
+            }
+            free(baseline);
+        }
     }
-    return a->pid - b->pid;
+    free(results);
+    return status;
 }
 
-int compare_priority(Process* a, Process* b) {
-    if (a->priority != b->priority) {
-        return a->priority - b->priority; // Lower number = higher priority
+// Round Robin quantum sweep (--quantum-sweep): successive halving over prefixes of the workload
+// in arrival order. Each round runs the remaining quanta in parallel on twice as many processes
+// as the round before and keeps the better half by the chosen metric; the last round runs the
+// whole workload, and its results are reported with their Pareto front.
+#define SWEEP_MAX_CANDIDATES 64
+#define SWEEP_FINALISTS 8           // Quanta run on the whole workload
+#define SWEEP_MIN_PREFIX 1000       // Smallest prefix quanta are ranked on
+
+enum SweepMetric { SWEEP_WAITING, SWEEP_P99_RESPONSE, SWEEP_SWITCHES, NUM_SWEEP_METRICS };
+const char* const sweep_metric_names[NUM_SWEEP_METRICS] = {"waiting", "p99-response", "switches"};
+
+typedef struct {
+    int quantum;
+    int processes;              // Size of the last prefix it ran on
+    double score[NUM_SWEEP_METRICS];
+    double key;                 // Score on the metric being tuned
+    SimMetrics metrics;         // Of the last round it ran in
+} SweepCandidate;
+
+// Copy of `source` with its records in arrival order (ties in pid order), sharing its
+// I/O table, so that every prefix is the start of the workload in time
+void workload_sort_by_arrival(const Workload* source, Workload* sorted) {
+    int count = source->count;
+    memset(sorted, 0, sizeof(*sorted));
+    sorted->io_operations = source->io_operations;
+    sorted->num_io_operations = source->num_io_operations;
+    sorted->phases = source->phases;
+    sorted->count = count;
+    const int* order = source->arrival_order;
+
+    size_t record_bytes = (size_t)(count > 0 ? count : 1) * sizeof(WorkloadRecord);
+    arena_init(&sorted->arena, arena_class_size(record_bytes));
+    WorkloadRecord* records = arena_alloc(&sorted->arena, record_bytes);
+    for (int i = 0; i < count; i++) records[i] = source->records[order != NULL ? order[i] : i];
+    sorted->records = records;
+    if (source->affinity != NULL) {
+        sorted->affinity = malloc((size_t)(count > 0 ? count : 1) * sizeof(CpuMask));
+        if (sorted->affinity == NULL) arena_out_of_memory((size_t)count * sizeof(CpuMask));
+        for (int i = 0; i < count; i++) sorted->affinity[i] = source->affinity[order != NULL ? order[i] : i];
     }
-    if (a->arrival_time != b->arrival_time) {
-        return a->arrival_time - b->arrival_time; // Earlier arrival breaks tie
+    if (source->realtime != NULL) {
+        RealtimeRecord* realtime = arena_alloc(&sorted->arena, (size_t)(count > 0 ? count : 1) * sizeof(RealtimeRecord));
+        for (int i = 0; i < count; i++) realtime[i] = source->realtime[order != NULL ? order[i] : i];
+        sorted->realtime = realtime;
     }
-    return a->pid - b->pid;
 }
 
-int compare_rr(Process* a, Process* b) {
-    if (a->queue_entry_time != b->queue_entry_time) {
-        return a->queue_entry_time - b->queue_entry_time; // FIFO order for RR
+// Quanta from `low` to `high`: every one, or SWEEP_MAX_CANDIDATES spaced geometrically
+int sweep_candidates(int low, int high, int* quanta) {
+    int count = 0;
+    if ((int64_t)high - low < SWEEP_MAX_CANDIDATES) {
+        for (int q = low; q <= high; q++) quanta[count++] = q;
+        return count;
     }
-    return a->pid - b->pid;
+    double ratio = pow((double)high / low, 1.0 / (SWEEP_MAX_CANDIDATES - 1));
+    for (int i = 0; i < SWEEP_MAX_CANDIDATES; i++) {
+        double value = i == SWEEP_MAX_CANDIDATES - 1 ? high : floor(low * pow(ratio, i) + 0.5);
+        int q = value > high ? high : (int)value;
+        if (count == 0 || q > quanta[count - 1]) quanta[count++] = q;
+    }
+    return count;
 }
 
-int compare_io_completion(Process* a, Process* b) {
-    if (a->io_complete_at_time != b->io_complete_at_time) {
-        return a->io_complete_at_time - b->io_complete_at_time; // Earlier completion first
-    }
-    return a->pid - b->pid;
+// Candidates kept after a round: the better half, but no fewer than the finalists
+int sweep_survivors(int alive) {
+    int half = (alive + 1) / 2;
+    return half > SWEEP_FINALISTS ? half : SWEEP_FINALISTS;
 }
 
-// Heap utility functions
-void heap_init(ProcessHeap* heap, int (*compare_func)(Process* a, Process* b)) {
-    heap->size = 0;
-    heap->compare = compare_func;
+int compare_sweep_key(const void* a, const void* b) {
+    const SweepCandidate* x = a;
+    const SweepCandidate* y = b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return x->quantum - y->quantum;
 }
 
-void heap_swap(ProcessHeap* heap, int i, int j) {
-    Process* temp = heap->heap[i];
-    heap->heap[i] = heap->heap[j];
-    heap->heap[j] = temp;
+int compare_sweep_quantum(const void* a, const void* b) {
+    return ((const SweepCandidate*)a)->quantum - ((const SweepCandidate*)b)->quantum;
 }
 
-void heap_heapify_up(ProcessHeap* heap, int index) {
-    if (index == 0) return;
-    
-    int parent = (index - 1) / 2;
-    if (heap->compare(heap->heap[index], heap->heap[parent]) < 0) {
-        heap_swap(heap, index, parent);
-        heap_heapify_up(heap, parent);
+// Candidate `c` is worse than or equal to `other` on every metric and worse on one
+int sweep_dominated(const SweepCandidate* c, const SweepCandidate* other) {
+    int worse = 0;
+    for (int m = 0; m < NUM_SWEEP_METRICS; m++) {
+        if (c->score[m] < other->score[m]) return 0;
+        if (c->score[m] > other->score[m]) worse = 1;
     }
+    return worse;
 }
 
-void heap_heapify_down(ProcessHeap* heap, int index) {
-    int left = 2 * index + 1;
-    int right = 2 * index + 2;
-    int smallest = index;
-
-    if (left < heap->size && heap->compare(heap->heap[left], heap->heap[smallest]) < 0) {
-        smallest = left;
+// Returns 0 on success
+int run_quantum_sweep(const Workload* workload, int low, int high, enum SweepMetric metric,
+                      const PolicyConfig* policy, const MachineConfig* machine, int num_threads, int csv_output,
+                      const char* cache_dir) {
+    int quanta[SWEEP_MAX_CANDIDATES];
+    int num_candidates = sweep_candidates(low, high, quanta);
+    SweepCandidate* candidates = calloc((size_t)num_candidates, sizeof(SweepCandidate));
+    BatchJob* jobs = calloc((size_t)num_candidates, sizeof(BatchJob));
+    SimMetrics* merged = malloc(NUM_SCHEDULER_VARIANTS * sizeof(SimMetrics));
+    if (candidates == NULL || jobs == NULL || merged == NULL) {
+        arena_out_of_memory((size_t)num_candidates * (sizeof(SweepCandidate) + sizeof(BatchJob)));
     }
-    if (right < heap->size && heap->compare(heap->heap[right], heap->heap[smallest]) < 0) {
-        smallest = right;
+    for (int i = 0; i < num_candidates; i++) candidates[i].quantum = quanta[i];
+
+    int halvings = 0;
+    for (int alive = num_candidates; alive > SWEEP_FINALISTS; alive = sweep_survivors(alive)) halvings++;
+    Workload sorted;
+    int copied = halvings > 0 && workload->arrival_order != NULL;
+    if (copied) workload_sort_by_arrival(workload, &sorted);
+
+    int rr = variant_by_key("rr");
+    int alive = num_candidates;
+    for (int round = 0; round <= halvings; round++) {
+        Workload prefix = copied ? sorted : *workload;
+        int remaining = halvings - round;
+        if (remaining > 0 && (prefix.count >> remaining) >= SWEEP_MIN_PREFIX) {
+            prefix.count >>= remaining;
+        } else if (remaining > 0 && prefix.count > SWEEP_MIN_PREFIX) {
+            prefix.count = SWEEP_MIN_PREFIX;
+        }
+        Digest digest = {{0, 0}};
+        if (cache_dir != NULL) workload_digest(&prefix, &digest);
+
+        for (int i = 0; i < alive; i++) {
+            memset(&jobs[i], 0, sizeof(jobs[i]));
+            jobs[i].workload = &prefix;
+            jobs[i].variant = rr;
+            jobs[i].policy = *policy;
+            jobs[i].policy.time_quantum = candidates[i].quantum;
+            jobs[i].machine = *machine;
+            jobs[i].result = &candidates[i].metrics;
+            jobs[i].cache_dir = cache_dir;
+            jobs[i].workload_digest = digest;
+        }
+        run_batch(jobs, alive, num_threads, merged);
+
+        for (int i = 0; i < alive; i++) {
+            SweepCandidate* c = &candidates[i];
+            c->processes = prefix.count;
+            c->score[SWEEP_WAITING] = stats_mean(&c->metrics.waiting.stats);
+            c->score[SWEEP_P99_RESPONSE] = distribution_quantile(&c->metrics.response, 0.99);
+            c->score[SWEEP_SWITCHES] = (double)c->metrics.context_switches;
+            c->key = c->score[metric];
+        }
+        qsort(candidates, (size_t)alive, sizeof(SweepCandidate), compare_sweep_key);
+        if (round < halvings) alive = sweep_survivors(alive);
     }
+    int best = candidates[0].quantum;
+    qsort(candidates, (size_t)alive, sizeof(SweepCandidate), compare_sweep_quantum);
 
-    if (smallest != index) {
-        heap_swap(heap, index, smallest);
-        heap_heapify_down(heap, smallest);
+    if (csv_output) {
+        printf("quantum,processes,avg_waiting,p99_response,context_switches,pareto\n");
+    } else {
+        printf("\n--- Quantum sweep: %d processes, quanta %d-%d (%d tried, %d pruned in %d rounds), metric %s ---\n",
+               workload->count, low, high, num_candidates, num_candidates - alive, halvings,
+               sweep_metric_names[metric]);
+        printf("\nQuantum | Avg Waiting | p99 Response | Switches | Pareto\n");
+        printf("--------|-------------|--------------|----------|-------\n");
     }
-}
+    for (int i = 0; i < alive; i++) {
+        const SweepCandidate* c = &candidates[i];
+        int pareto = 1;
+        for (int j = 0; j < alive && pareto; j++) pareto = !sweep_dominated(c, &candidates[j]);
+        if (csv_output) {
+            printf("%d,%d,%.4f,%.0f,%.0f,%d\n", c->quantum, c->processes, c->score[SWEEP_WAITING],
+                   c->score[SWEEP_P99_RESPONSE], c->score[SWEEP_SWITCHES], pareto);
+        } else {
+            printf("%7d | %11.2f | %12.0f | %8.0f | %s\n", c->quantum, c->score[SWEEP_WAITING],
+                   c->score[SWEEP_P99_RESPONSE], c->score[SWEEP_SWITCHES], pareto ? "yes" : "");
+        }
+    }
+    if (!csv_output) printf("\nBest quantum by %s: %d\n", sweep_metric_names[metric], best);
 
-void heap_insert(ProcessHeap* heap, Process* process) {
-    if (heap->size >= MAX_PROCESSES) return;
-    
-    heap->heap[heap->size] = process;
-    heap_heapify_up(heap, heap->size);
-    heap->size++;
+    if (copied) workload_free(&sorted);
+    free(candidates);
+    free(jobs);
+    free(merged);
+    return 0;
 }
 
-Process* heap_extract_min(ProcessHeap* heap) {
-    if (heap->size == 0) return NULL;
-    
-    Process* min = heap->heap[0];
-    heap->heap[0] = heap->heap[heap->size - 1];
-    heap->size--;
-    
-    if (heap->size > 0) {
-        heap_heapify_down(heap, 0);
+// Command-line batch mode
+// Streaming run: a report every `window` time units up to `duration`, each covering the last
+// `span` windows
+typedef struct {
+    const char* path;           // Text workload in arrival order ("-": standard input), NULL: generated
+    int64_t duration;
+    int window;
+    int span;
+} StreamOptions;
+
+// CPU time spent running processes up to `now`, running slices included
+int64_t stream_busy_time(const SimContext* ctx, int64_t now) {
+    int64_t busy = 0;
+    for (int c = 0; c < ctx->machine.num_cpus; c++) {
+        const Cpu* cpu = &ctx->cpus[c];
+        busy += cpu->busy_time;
+        if (cpu->running != NULL && cpu->run_start < now) busy += now - cpu->run_start;
     }
-    
-    return min;
+    return busy;
 }
 
-// Remove specific process from heap (for preemption)
-int heap_remove_process(ProcessHeap* heap, int pid) {
-    int index = -1;
-    for (int i = 0; i < heap->size; i++) {
-        if (heap->heap[i]->pid == pid) {
-            index = i;
-            break;
-        }
+// Report of the windows in the span ending at `end`
+void print_stream_window(const StreamState* stream, const char* label, int64_t end, int num_cpus, int filled,
+                         int csv_output) {
+    StreamWindow total;
+    memset(&total, 0, sizeof(total));
+    for (int i = 0; i < filled; i++) {
+        const StreamWindow* w = &stream->windows[(stream->current_window - i + stream->num_windows) % stream->num_windows];
+        total.completed += w->completed;
+        distribution_merge(&total.waiting, &w->waiting);
+        total.busy += w->busy;
+        total.length += w->length;
     }
-    
-    if (index == -1) return 0; // Process not found
-    
-    heap->heap[index] = heap->heap[heap->size - 1];
-    heap->size--;
-    
-    if (heap->size > 0 && index < heap->size) {
-        // Try both up and down heapify
-        int parent = (index - 1) / 2;
-        if (index > 0 && heap->compare(heap->heap[index], heap->heap[parent]) < 0) {
-            heap_heapify_up(heap, index);
-        } else {
-            heap_heapify_down(heap, index);
-        }
+    double length = total.length > 0 ? total.length : 1;
+    double throughput = (double)total.completed / length;
+    double utilization = (double)total.busy / (length * num_cpus);
+    if (csv_output) {
+        printf("%s,%lld,%d,%llu,%.6f,%.4f,%.4f,%.0f,%.0f,%.0f,%lld\n", label, (long long)end, stream->live,
+               (unsigned long long)total.completed, throughput, utilization, stats_mean(&total.waiting.stats),
+               distribution_quantile(&total.waiting, 0.50), distribution_quantile(&total.waiting, 0.95),
+               distribution_quantile(&total.waiting, 0.99), (long long)total.waiting.stats.max);
+    } else {
+        printf("%10lld | %9d | %9llu | %10.4f | %6.2f | %11.2f | %11.0f | %11.0f | %11lld\n", (long long)end,
+               stream->live,
+               (unsigned long long)total.completed, throughput, 100.0 * utilization,
+               stats_mean(&total.waiting.stats), distribution_quantile(&total.waiting, 0.95),
+               distribution_quantile(&total.waiting, 0.99), (long long)total.waiting.stats.max);
     }
-    
-    return 1; // Success
 }
 
-void sort_processes_by_arrival(Process p_arr[], int n) {
-    for (int i = 0; i < n - 1; i++) {
-        for (int j = 0; j < n - i - 1; j++) {
-            if (p_arr[j].arrival_time > p_arr[j + 1].arrival_time) {
-                Process temp = p_arr[j];
-                p_arr[j] = p_arr[j + 1];
-                p_arr[j + 1] = temp;
-            }
-        }
+// Run one variant as an open system. The overall metrics of the completed processes go to
+// `result`. Returns 0 on success.
+int run_stream_variant(const StreamOptions* options, int variant_index, const GeneratorConfig* generator,
+                       const Workload* shell, const PolicyConfig* policy, const MachineConfig* machine,
+                       int csv_output, SimMetrics* result) {
+    const SchedulerVariant* variant = &scheduler_variants[variant_index];
+    StreamState stream;
+    if (stream_init(&stream, options->span) != 0) return -1;
+    if (stream_source_open(&stream.source, options->path, generator, options->duration) != 0) {
+        stream_free(&stream);
+        return -1;
+    }
+
+    SimContext ctx;
+    sim_context_init(&ctx, shell);
+    ctx.verbose = 0;
+    ctx.policy = *policy;
+    ctx.machine = *machine;
+    ctx.stream = &stream;
+    sim_start(&ctx, variant->name, variant->mode, variant->preemption_mode);
+
+    if (!csv_output) {
+        printf("\n--- %s: window %d, each row over the last %lld ---\n", variant->label, options->window,
+               (long long)options->window * options->span);
+        printf("      Time | In system | Completed | Throughput | Util %% | Avg Waiting | p95 Waiting "
+               "| p99 Waiting | Max Waiting\n");
+        printf("-----------|-----------|-----------|------------|--------|-------------|-------------"
+               "|-------------|------------\n");
+    }
+    int64_t busy_before = 0;
+    int filled = 0, finished = 0;
+    int64_t start = 0;
+    while (!finished && start < options->duration) {
+        int64_t end = options->duration - start > options->window ? start + options->window : options->duration;
+        finished = sim_run_until(&ctx, variant->name, end);
+        StreamWindow* w = &stream.windows[stream.current_window];
+        int64_t busy = stream_busy_time(&ctx, end);
+        w->busy = busy - busy_before;
+        w->length = end - start;
+        busy_before = busy;
+        if (filled < stream.num_windows) filled++;
+        print_stream_window(&stream, csv_output ? variant->key : "", end, machine->num_cpus, filled, csv_output);
+        stream.current_window = (stream.current_window + 1) % stream.num_windows;
+        memset(&stream.windows[stream.current_window], 0, sizeof(StreamWindow));
+        start = end;
+    }
+
+    metrics_record_cpus(&ctx);
+    instr_collect_heaps(&ctx, variant->mode);
+    Evaluation(&ctx, variant->name);
+    ctx.metrics.peak_memory += (size_t)stream.used_slots *
+                               (sizeof(Process) + MAX_IO_OPERATIONS * sizeof(IOOperation) + sizeof(CfsEntity));
+    ctx.metrics.num_processes = stream.admitted < INT_MAX ? (int)stream.admitted : INT_MAX;
+    ctx.metrics.total_makespan = (double)(finished ? ctx.current_time : start);   // The observed period
+    ctx.metrics.total_busy_time = (double)busy_before;                  // Processes still running included
+    if (!csv_output) {
+        printf("Processes: %lld arrived, %d completed, %d still in the system (at most %d at once)\n",
+               (long long)stream.admitted, ctx.metrics.completed_count, stream.live, stream.peak_live);
     }
+    *result = ctx.metrics;
+    int status = stream.overflow ? -1 : 0;
+    sim_context_free(&ctx);
+    stream_free(&stream);
+    return status;
 }
 
-void display_menu() {
-    printf("--------------------------------------\n");
-    printf("         CPU SCHEDULING SIMULATOR \n\n");
-    printf("1. Create random processes\n");
-    printf("2. FCFS scheduling\n");
-    printf("3. SJF (Non-Preemptive) scheduling\n");
-    printf("4. SJF (Preemptive) scheduling\n");
-    printf("5. Priority (Non-Preemptive) scheduling\n");
-    printf("6. Priority (Preemptive) scheduling\n");
-    printf("7. Round Robin scheduling\n");
-    printf("0. Exit\n\n");
-    printf("Choice: ");
+typedef struct {
+    const char* workload_path;      // Binary workload (mapped)
+    const char* csv_path;           // Text workload
+    const char* sched_trace_path;   // ftrace / perf sched text trace
+    const char* tasks_path;         // Periodic task set
+    int horizon;                    // Release jobs of the task set until this time, 0: hyperperiod
+    int sched_tick;                 // Microseconds per time unit of an imported trace
+    int random_count;               // Random workload size
+    GeneratorConfig generator;      // Seed and distributions of the random workload
+    const char* save_path;          // Save the workload in binary form
+    int selected[NUM_SCHEDULER_VARIANTS];
+    PolicyConfig policy;            // Quanta and other tunables of the algorithms
+    MachineConfig machine;          // Simulated CPUs
+    const char* affinity_path;      // CPU affinity masks of the workload's processes
+    const char* shares_path;        // Lottery and stride tickets of the workload's processes
+    PhaseModel phases;              // Generated CPU/I/O phases replacing the workload's I/O operations
+    int use_phases;
+    int num_threads;
+    int verbose;                    // Full Evaluation report per run
+    int csv_output;
+    const char* trace_path;         // Trace file; one per algorithm when several run
+    enum TraceFormat trace_format;
+    const char* counters_path;      // Engine counters as JSON ("-": stdout)
+    const char* cache_dir;          // Result cache directory
+    int sweep[2];                   // Round Robin quantum sweep range, {0, 0} if none
+    enum SweepMetric sweep_metric;
+    int64_t fork_at;                // What-if checkpoint time, -1 for independent runs
+    const char* fork_from;          // Variant run up to the checkpoint (default: first selected)
+    StreamOptions stream;           // Open-system run if stream.duration > 0
+    int bench;                      // Benchmark mode instead of a single workload
+    BenchOptions bench_options;
+} BatchOptions;
+
+void print_usage(const char* program) {
+    printf("Usage: %s [options]           (no options: interactive menu)\n", program);
+    printf("       %s --import FILE.csv --output FILE.bin\n", program);
+    printf("       %s --trace-convert TRACE.bin --output TRACE.json\n", program);
+    printf("       %s --bench [benchmark options] [scheduling options]\n\n", program);
+    printf("Workload (one of):\n");
+    printf("  --workload FILE      binary workload file (memory-mapped)\n");
+    printf("  --csv FILE           text workload: pid,arrival,cpu_burst,priority[,req:burst;...\n");
+    printf("                       [,deadline[,period]]] (deadline relative to the arrival)\n");
+    printf("  --tasks FILE         periodic task set: pid,period,cpu_burst,priority[,deadline[,jitter]]\n");
+    printf("                       per line; each task releases a job every period, arriving up to\n");
+    printf("                       jitter later (seeded by --seed) and due deadline after the release\n");
+    printf("                       (default: the period)\n");
+    printf("  --horizon T          release --tasks jobs until T (default: the hyperperiod)\n");
+    printf("  --sched-trace FILE   Linux scheduler trace (ftrace or perf sched script text with\n");
+    printf("                       sched_switch/sched_wakeup): one process per task, blocked\n");
+    printf("                       intervals as I/O operations\n");
+    printf("  --sched-tick US      microseconds per time unit of --sched-trace (default 10); the\n");
+    printf("                       scheduling options below use the same unit\n");
+    printf("  --random N           N random processes\n");
+    printf("  --seed S             seed for --random (default: current time); the same seed and\n");
+    printf("                       options give the same workload for any --threads\n");
+    printf("  --arrivals MODEL     uniform:MAX (default uniform:19), poisson:RATE or\n");
+    printf("                       onoff:RATE,BURST,GAP (bursts of mean BURST processes, idle gaps of mean GAP)\n");
+    printf("  --cpu-burst DIST     uniform:MIN,MAX (default uniform:5,24), exp:MEAN,\n");
+    printf("                       lognormal:MU,SIGMA or pareto:SCALE,SHAPE\n");
+    printf("  --io-burst DIST      I/O burst distribution (default uniform:2,9)\n");
+    printf("  --io-count N         I/O operations per process, 0-%d (default random 0-%d)\n",
+           MAX_IO_OPERATIONS, MAX_IO_OPERATIONS - 1);
+    printf("  --phases CPU/IO      ignore the workload's I/O operations: every process alternates CPU\n");
+    printf("                       bursts from distribution CPU and I/O bursts from IO, drawn as it\n");
+    printf("                       runs, e.g. exp:6/uniform:2,9 (seeded by --seed, default 1)\n");
+    printf("  --save FILE          write the workload as a binary workload file\n\n");
+    printf("Scheduling:\n");
+    printf("  --algorithm LIST     comma-separated fcfs,sjf,priority,rr,mlfq,cfs,edf,rm,lottery,stride\n");
+    printf("                       or all (default all; edf and rm only with deadlines unless named)\n");
+    printf("  --preemption MODE    on, off or both (default both; FCFS, RR, lottery and stride are\n");
+    printf("                       non-preemptive, MLFQ, CFS, EDF and RM preemptive)\n");
+    printf("  --quantum Q          Round Robin, lottery and stride time quantum (default %d)\n", TIME_QUANTUM);
+    printf("  --mlfq-quanta LIST   MLFQ time quantum per level, top level first, up to %d levels\n",
+           MLFQ_MAX_LEVELS);
+    printf("                       (default %d,%d,%d)\n", TIME_QUANTUM, TIME_QUANTUM * 2, TIME_QUANTUM * 4);
+    printf("  --mlfq-boost T       move every process back to the top MLFQ level every T time units,\n");
+    printf("                       0 never (default %d)\n", MLFQ_BOOST_PERIOD);
+    printf("  --cfs-latency T      CFS scheduling period shared by the runnable processes (default %d)\n",
+           CFS_TARGET_LATENCY);
+    printf("  --cfs-granularity G  shortest CFS slice; the period grows by G per process beyond\n");
+    printf("                       latency/G runnable ones (default %d)\n", CFS_MIN_GRANULARITY);
+    printf("  --shares FILE        lottery and stride tickets, one process per line: pid:tickets, 1-%d\n",
+           SHARE_MAX_TICKETS);
+    printf("                       (default: the CFS weight of the priority, 1024 at priority %d);\n",
+           PRIORITY_LEVELS / 2);
+    printf("                       lottery draws are seeded by --seed (default 1)\n");
+    printf("  --share-window W     measure the CPU time each lottery or stride process receives\n");
+    printf("                       against its share every W time units, 0 never (default %d)\n", SHARE_WINDOW);
+    printf("  --cpus N             simulated CPUs, 1-%d (default 1); each has its own ready queue and\n", MAX_CPUS);
+    printf("                       idle CPUs steal waiting processes from busy ones\n");
+    printf("  --migration-cost C   time lost when a process runs on another CPU than before (default 0)\n");
+    printf("  --switch-cost C      CPU time of every context switch (default 0)\n");
+    printf("  --preempt-cost C     extra CPU time of a switch after a preemption or quantum expiry\n");
+    printf("                       (default 0)\n");
+    printf("  --cache-refill C,T   a dispatched process refills its cache for C time units if it was\n");
+    printf("                       off the CPU for T or longer, in proportion if for less (default none)\n");
+    printf("  --affinity FILE      CPU affinity, one process per line: pid:cpu-list (e.g. 7:0-3,8)\n");
+    printf("  --threads N          worker threads (default: all cores)\n");
+    printf("  --cache DIR          keep the results of runs in DIR and reuse them when the workload,\n");
+    printf("                       algorithm and its settings are the same (not with --verbose or\n");
+    printf("                       --fork-at; runs with --trace are simulated but kept)\n");
+    printf("  --quantum-sweep L,H  tune the Round Robin quantum between L and H: quanta are ranked on\n");
+    printf("                       growing prefixes of the workload, the best half kept each round, and\n");
+    printf("                       the last %d run on all of it; prints their Pareto front\n", SWEEP_FINALISTS);
+    printf("  --sweep-metric M     waiting, p99-response or switches (default waiting)\n");
+    printf("  --fork-at T          what-if: run one algorithm up to time T, then continue from that\n");
+    printf("                       checkpoint once per selected algorithm (forked processes)\n");
+    printf("  --fork-from NAME     algorithm run up to the checkpoint, e.g. rr or sjf-p\n");
+    printf("                       (default: the first selected)\n");
+    printf("  --stream T           open system for T time units: processes are generated (with\n");
+    printf("                       --arrivals poisson or onoff) or read from --csv FILE (- for stdin,\n");
+    printf("                       in arrival order) as they arrive and dropped once complete\n");
+    printf("  --stream-window W    report throughput, utilization and waiting time every W time\n");
+    printf("                       units (default 1000)\n");
+    printf("  --window-span N      each report covers the last N windows (default 1)\n\n");
+    printf("Output:\n");
+    printf("  --verbose            full Gantt chart and process details per algorithm\n");
+    printf("  --format text|csv    summary format (default text)\n");
+    printf("  --trace FILE         stream the schedule to FILE; with several algorithms each gets\n");
+    printf("                       its own file, e.g. run.sjf-p.json\n");
+    printf("  --trace-format FMT   binary or chrome (Chrome/Perfetto JSON); default chrome for\n");
+    printf("                       .json files, binary otherwise\n");
+    printf("  --counters FILE      engine counters per algorithm as JSON (- for stdout); build with\n");
+    printf("                       -DSIM_INSTRUMENT=2 to add per-phase timing, 0 to remove them\n\n");
+    printf("Benchmark (--bench):\n");
+    printf("  --bench-sizes LIST   processes per workload (default 100,1000,...,10000000)\n");
+    printf("  --bench-io LIST      I/O operations per process, 0-%d (default all)\n", MAX_IO_OPERATIONS);
+    printf("  --bench-repeat N     runs per point, fastest counts (default 3)\n");
+    printf("                       (workloads use --seed, default 1)\n");
+    printf("  --bench-budget S     skip the remaining points once a run takes over S seconds (default 10)\n");
+    printf("  --bench-output FILE  write the results as CSV\n");
+    printf("  --bench-baseline F   compare with earlier CSV results; exit status 2 on a regression\n");
+    printf("  --bench-tolerance P  allowed slowdown in percent (default 10)\n");
 }
 
-void Create_Process() {
-    printf("Enter number of processes (e.g., 5): ");
-    if (scanf("%d", &num_processes) != 1 || num_processes <= 0 || num_processes > MAX_PROCESSES) {
-        printf("Invalid number of processes. Setting to default 5.\n");
-        num_processes = 5;
-        while (getchar() != '\n');
+// Trace file of one variant: `base` itself, or with the variant key before the extension
+void trace_path_for_variant(const char* base, const char* key, int several, char* out, size_t size) {
+    if (!several) {
+        snprintf(out, size, "%s", base);
+        return;
+    }
+    const char* slash = strrchr(base, '/');
+    const char* dot = strrchr(base, '.');
+    if (dot == NULL || (slash != NULL && dot < slash) || dot == base || dot[-1] == '/') {
+        snprintf(out, size, "%s.%s", base, key);
+    } else {
+        snprintf(out, size, "%.*s.%s%s", (int)(dot - base), base, key, dot);
     }
+}
 
-    srand(time(NULL));
-    printf("\n--- Generating Random Processes ---\n");
-    printf("PID | Arrival | CPU Burst | Priority | I/O Operations\n");
-    printf("----|---------|-----------|----------|---------------\n");
+// Returns 0 on success. Real-time algorithms chosen by name are marked 2; those chosen by "all"
+// only run on workloads with deadlines (deselect_unnamed_realtime).
+int parse_algorithms(const char* list, int algorithms[NUM_SCHEDULING_MODES]) {
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%s", list);
+    memset(algorithms, 0, NUM_SCHEDULING_MODES * sizeof(int));
 
-    for (int i = 0; i < num_processes; i++) {
-        original_processes[i].pid = i + 1;
-        original_processes[i].arrival_time = rand() % 20;
-        original_processes[i].cpu_burst_time_initial = (rand() % 20) + 5; // 5~24
-        original_processes[i].priority = rand() % 10;
-        
-        // 여러 I/O 작업 생성 (0~4개)
-        original_processes[i].num_io_operations = (rand() % MAX_IO_OPERATIONS);
-        original_processes[i].current_io_index = 0;
-        
-        printf("%3d | %7d | %9d | %8d | ",
-               original_processes[i].pid, original_processes[i].arrival_time,
-               original_processes[i].cpu_burst_time_initial, original_processes[i].priority);
-        
-        if(original_processes[i].num_io_operations == 0){
-            printf("No I/O Operations");
+    for (char* name = strtok(buffer, ","); name != NULL; name = strtok(NULL, ",")) {
+        if (strcmp(name, "all") == 0) {
+            for (int m = 0; m < NUM_SCHEDULING_MODES; m++) algorithms[m] = 1;
+        } else if (strcmp(name, "fcfs") == 0) {
+            algorithms[FCFS_MODE] = 1;
+        } else if (strcmp(name, "sjf") == 0) {
+            algorithms[SJF_MODE] = 1;
+        } else if (strcmp(name, "priority") == 0) {
+            algorithms[PRIORITY_MODE] = 1;
+        } else if (strcmp(name, "rr") == 0) {
+            algorithms[RR_MODE] = 1;
+        } else if (strcmp(name, "mlfq") == 0) {
+            algorithms[MLFQ_MODE] = 1;
+        } else if (strcmp(name, "cfs") == 0) {
+            algorithms[CFS_MODE] = 1;
+        } else if (strcmp(name, "edf") == 0) {
+            algorithms[EDF_MODE] = 2;
+        } else if (strcmp(name, "rm") == 0) {
+            algorithms[RM_MODE] = 2;
+        } else if (strcmp(name, "lottery") == 0) {
+            algorithms[LOTTERY_MODE] = 1;
+        } else if (strcmp(name, "stride") == 0) {
+            algorithms[STRIDE_MODE] = 1;
+        } else {
+            fprintf(stderr, "Unknown algorithm '%s'\n", name);
+            return -1;
         }
+    }
+    return 0;
+}
 
-        for (int j = 0; j < original_processes[i].num_io_operations; j++) {
-            // I/O 요청 시점을 CPU 실행 시간 내에서 분산
-            int segment_size = original_processes[i].cpu_burst_time_initial / (original_processes[i].num_io_operations + 1);
-            original_processes[i].io_operations[j].request_time = segment_size * (j + 1) + (rand() % (segment_size / 2 + 1));
-            
-            // I/O 요청 시점이 CPU 실행 시간을 초과하지 않도록 조정
-            if (original_processes[i].io_operations[j].request_time >= original_processes[i].cpu_burst_time_initial) {
-            original_processes[i].io_operations[j].request_time = original_processes[i].cpu_burst_time_initial - 1;
-            }
-            
-            original_processes[i].io_operations[j].burst_time = (rand() % 8) + 2; // 2~9
-            
-            printf("I/O.%d - [req: %d, burst: %d] ", j+1, 
-                   original_processes[i].io_operations[j].request_time,
-                   original_processes[i].io_operations[j].burst_time);
-        }
-        printf("\n");
+// EDF and RM order by deadlines and periods; without them they only repeat FCFS
+void deselect_unnamed_realtime(int selected[NUM_SCHEDULER_VARIANTS], const int algorithms[NUM_SCHEDULING_MODES]) {
+    for (int v = 0; v < NUM_SCHEDULER_VARIANTS; v++) {
+        enum SchedulingMode mode = scheduler_variants[v].mode;
+        if (realtime_mode(mode) && algorithms[mode] != 2) selected[v] = 0;
     }
-    
-    printf("\n--- Processes Created Successfully ---\n");
 }
 
-void Config() {
-    printf("\n--- System Configuration ---\n");
+int parse_positive(const char* text, int* value) {
+    char* end;
+    long parsed = strtol(text, &end, 10);
+    if (*text == '\0' || *end != '\0' || parsed <= 0 || parsed > INT_MAX) return 0;
+    *value = (int)parsed;
+    return 1;
+}
 
-    printf("\n    Ready Queue Configuration\n");
-    heap_init(&ready_queue, compare_fcfs); // Default initialization, will be reconfigured per algorithm
-     
-    printf("    Waiting Queue Configuration\n");
-    heap_init(&waiting_queue, compare_io_completion);
-    
-    printf("\n--- Configuration Complete ---\n");
+// A time of at least `min`; simulated time is 64-bit
+int parse_time(const char* text, int64_t min, int64_t* value) {
+    char* end;
+    errno = 0;
+    long long parsed = strtoll(text, &end, 10);
+    if (*text == '\0' || *end != '\0' || parsed < min || errno == ERANGE) return 0;
+    *value = parsed;
+    return 1;
 }
 
-void reset_processes_for_simulation() {
-    for (int i = 0; i < num_processes; i++) {
-        processes[i] = original_processes[i];
-        processes[i].remaining_cpu_total = processes[i].cpu_burst_time_initial;
-        processes[i].cpu_done_current_segment = 0;
-        processes[i].total_cpu_done = 0;
-        processes[i].current_io_index = 0;
-        processes[i].start_time = -1;
-        processes[i].completion_time = 0;
-        processes[i].waiting_time = 0;
-        processes[i].turnaround_time = 0;
-        processes[i].response_time = -1;
-        processes[i].state = 0;
-        processes[i].io_complete_at_time = 0;
-        processes[i].has_started_execution = 0;
-        processes[i].last_active_time = processes[i].arrival_time;
-        processes[i].current_quantum_slice = 0;
-        processes[i].queue_entry_time = 0;
-    }
-    sort_processes_by_arrival(processes, num_processes);
-
-    // Reset queues (they are already configured in Config())
-    ready_queue.size = 0;
-    waiting_queue.size = 0;
-    gantt_idx = 0;
-}
-
-void add_gantt_entry(int pid, int start, int end) {
-    if (gantt_idx > 0 && gantt_chart[gantt_idx-1].pid == pid && gantt_chart[gantt_idx-1].end == start) {
-        gantt_chart[gantt_idx-1].end = end;
-    } 
-    else if (gantt_idx < MAX_PROCESSES * 50) {
-        gantt_chart[gantt_idx].pid = pid;
-        gantt_chart[gantt_idx].start = start;
-        gantt_chart[gantt_idx].end = end;
-        gantt_idx++;
+int option_takes_value(const char* arg) {
+    static const char* const value_options[] = {
+        "--workload", "--csv", "--tasks", "--horizon", "--sched-trace", "--sched-tick", "--random", "--seed", "--arrivals", "--cpu-burst", "--io-burst", "--io-count", "--phases", "--save", "--import", "--output",
+        "--algorithm", "--preemption", "--quantum", "--mlfq-quanta", "--mlfq-boost", "--cfs-latency",
+        "--cfs-granularity", "--shares", "--share-window", "--cpus", "--migration-cost", "--switch-cost", "--preempt-cost", "--cache-refill", "--affinity", "--threads", "--cache", "--quantum-sweep", "--sweep-metric", "--fork-at", "--fork-from", "--stream", "--stream-window",
+        "--window-span", "--format",
+        "--trace", "--trace-format", "--trace-convert",
+        "--counters", "--bench-sizes", "--bench-io", "--bench-repeat", "--bench-budget", "--bench-output",
+        "--bench-baseline", "--bench-tolerance",
+    };
+    for (size_t i = 0; i < sizeof(value_options) / sizeof(value_options[0]); i++) {
+        if (strcmp(arg, value_options[i]) == 0) return 1;
     }
+    return 0;
 }
 
-void Evaluation(const char* algo_name) {
-    float total_waiting_time = 0;
-    float total_turnaround_time = 0;
-    int completed_count = 0;
-
-    printf("\n--- Evaluation for %s ---\n", algo_name);
+// --stream: every selected variant as an open system, one after another
+int run_stream_main(BatchOptions* options) {
+    StreamOptions* stream = &options->stream;
+    int num_selected = 0;
+    for (int v = 0; v < NUM_SCHEDULER_VARIANTS; v++) num_selected += options->selected[v];
+    if (options->workload_path != NULL || options->sched_trace_path != NULL || options->tasks_path != NULL ||
+        options->random_count > 0 || options->sweep[0] > 0 ||
+        options->fork_at >= 0 || options->trace_path != NULL || options->verbose || options->affinity_path != NULL ||
+        options->shares_path != NULL || options->cache_dir != NULL || options->save_path != NULL) {
+        fprintf(stderr, "--stream reads --csv or generates processes; it does not support --workload, --tasks, "
+                        "--sched-trace, --random, --quantum-sweep, --fork-at, --trace, --verbose, --affinity, "
+                        "--shares, --cache or --save\n");
+        return 1;
+    }
+    for (int v = 0; v < NUM_SCHEDULER_VARIANTS; v++) {
+        if (options->selected[v] && realtime_mode(scheduler_variants[v].mode)) {
+            fprintf(stderr, "--stream has no deadlines for %s\n", scheduler_variants[v].label);
+            return 1;
+        }
+    }
+    stream->path = options->csv_path;
+    if (stream->path == NULL && options->generator.arrivals.kind == ARRIVAL_UNIFORM) {
+        fprintf(stderr, "--stream needs --arrivals poisson:RATE or onoff:RATE,BURST,GAP to generate processes\n");
+        return 1;
+    }
+    if (stream->path != NULL && strcmp(stream->path, "-") == 0 && num_selected > 1) {
+        fprintf(stderr, "Standard input can only be streamed through one algorithm\n");
+        return 1;
+    }
+    if (stream->path == NULL) {
+        fprintf(stderr, "Generated stream, seed %llu\n", (unsigned long long)options->generator.seed);
+    }
 
-    // Print Gantt Chart
-    printf("\nGantt Chart:\n|");
-    for (int i = 0; i < gantt_idx; i++) {
-        if (gantt_chart[i].start < gantt_chart[i].end) {
-            printf(" P%d (%d-%d) |", gantt_chart[i].pid, gantt_chart[i].start, gantt_chart[i].end);
+    Workload shell;
+    memset(&shell, 0, sizeof(shell));
+    if (options->use_phases) shell.phases = &options->phases;
+    SimMetrics merged[NUM_SCHEDULER_VARIANTS];
+    memset(merged, 0, sizeof(merged));
+    if (options->csv_output) {
+        printf("algorithm,time,in_system,completed,throughput,utilization,avg_waiting,p50_waiting,p95_waiting,"
+               "p99_waiting,max_waiting\n");
+    }
+    int status = 0;
+    for (int v = 0; v < NUM_SCHEDULER_VARIANTS; v++) {
+        if (!options->selected[v]) continue;
+        if (run_stream_variant(stream, v, &options->generator, &shell, &options->policy, &options->machine,
+                               options->csv_output, &merged[v]) != 0) {
+            status = -1;
         }
     }
-    printf("\n");
+    if (!options->csv_output) {
+        printf("\n--- Stream totals: %lld time units, completed processes only ---\n",
+               (long long)stream->duration);
+        print_batch_results(merged);
+    }
+    if (options->counters_path != NULL && write_counters_json(options->counters_path, merged) != 0) status = -1;
+    return status == 0 ? 0 : 1;
+}
 
-    printf("\nProcess Details:\n");
-    printf("PID | Arrival | Completion | Turnaround | Waiting | Response\n");
-    printf("----|---------|------------|------------|---------|---------\n");
+int batch_main(int argc, char** argv) {
+    BatchOptions options;
+    memset(&options, 0, sizeof(options));
+    generator_defaults(&options.generator, (uint64_t)time(NULL));
+    policy_defaults(&options.policy);
+    options.machine.num_cpus = 1;
+    options.num_threads = default_thread_count();
+    options.fork_at = -1;
+    options.phases.seed = 1;
+    options.stream.window = 1000;
+    options.stream.span = 1;
+    options.sched_tick = 10;
 
-    for (int i = 0; i < num_processes; i++) {
-        Process p_eval;
-        int found = 0;
-        for (int j = 0; j < num_processes; ++j) {
-            if (processes[j].pid == original_processes[i].pid) {
-                p_eval = processes[j];
-                found = 1;
-                break;
-            }
-        }
-        if (!found) continue;
+    const char* import_path = NULL;
+    const char* output_path = NULL;
+    const char* convert_path = NULL;
+    int trace_format_given = 0;
+    int algorithms[NUM_SCHEDULING_MODES];
+    for (int m = 0; m < NUM_SCHEDULING_MODES; m++) algorithms[m] = 1;
+    int preemptive = 1, non_preemptive = 1;
 
-        if (p_eval.state == 4) {
-            p_eval.turnaround_time = p_eval.completion_time - p_eval.arrival_time;
-            if (p_eval.waiting_time < 0) p_eval.waiting_time = 0;
+    BenchOptions* bench = &options.bench_options;
+    bench->num_sizes = 0;
+    for (int size = 100; size <= 10000000; size *= 10) bench->sizes[bench->num_sizes++] = size;
+    bench->num_io_counts = 0;
+    for (int io = 0; io <= MAX_IO_OPERATIONS; io++) bench->io_counts[bench->num_io_counts++] = io;
+    bench->repeat = 3;
+    bench->seed = 1;        // Fixed unless --seed is given, so results stay comparable
+    bench->budget = 10.0;
+    bench->tolerance = 10.0;
 
-            printf("%3d | %7d | %10d | %10d | %7d | %8d\n",
-                   p_eval.pid, p_eval.arrival_time, p_eval.completion_time,
-                   p_eval.turnaround_time, p_eval.waiting_time, p_eval.response_time);
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (option_takes_value(arg) && value == NULL) {
+            fprintf(stderr, "Missing value for %s\n", arg);
+            return 1;
+        }
 
-            total_waiting_time += p_eval.waiting_time;
-            total_turnaround_time += p_eval.turnaround_time;
-            completed_count++;
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (strcmp(arg, "--verbose") == 0) {
+            options.verbose = 1;
+            continue;
+        } else if (strcmp(arg, "--bench") == 0) {
+            options.bench = 1;
+            continue;
+        } else if (strcmp(arg, "--bench-sizes") == 0) {
+            bench->num_sizes = parse_int_list(value, bench->sizes, BENCH_MAX_POINTS, 1, INT_MAX);
+            if (bench->num_sizes <= 0) {
+                fprintf(stderr, "Invalid benchmark sizes '%s'\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--bench-io") == 0) {
+            bench->num_io_counts = parse_int_list(value, bench->io_counts, BENCH_MAX_POINTS, 0, MAX_IO_OPERATIONS);
+            if (bench->num_io_counts <= 0) {
+                fprintf(stderr, "Invalid I/O counts '%s' (0-%d)\n", value, MAX_IO_OPERATIONS);
+                return 1;
+            }
+        } else if (strcmp(arg, "--bench-repeat") == 0) {
+            if (!parse_positive(value, &bench->repeat)) {
+                fprintf(stderr, "Invalid repeat count '%s'\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--bench-budget") == 0 || strcmp(arg, "--bench-tolerance") == 0) {
+            char* end;
+            double parsed = strtod(value, &end);
+            if (*value == '\0' || *end != '\0' || parsed <= 0) {
+                fprintf(stderr, "Invalid value '%s' for %s\n", value, arg);
+                return 1;
+            }
+            if (strcmp(arg, "--bench-budget") == 0) {
+                bench->budget = parsed;
+            } else {
+                bench->tolerance = parsed;
+            }
+        } else if (strcmp(arg, "--counters") == 0) {
+            options.counters_path = value;
+        } else if (strcmp(arg, "--bench-output") == 0) {
+            bench->output_path = value;
+        } else if (strcmp(arg, "--bench-baseline") == 0) {
+            bench->baseline_path = value;
+        } else if (strcmp(arg, "--workload") == 0) {
+            options.workload_path = value;
+        } else if (strcmp(arg, "--csv") == 0) {
+            options.csv_path = value;
+        } else if (strcmp(arg, "--tasks") == 0) {
+            options.tasks_path = value;
+        } else if (strcmp(arg, "--horizon") == 0) {
+            if (!parse_positive(value, &options.horizon)) {
+                fprintf(stderr, "Invalid horizon '%s'\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--sched-trace") == 0) {
+            options.sched_trace_path = value;
+        } else if (strcmp(arg, "--sched-tick") == 0) {
+            if (!parse_positive(value, &options.sched_tick) || options.sched_tick > INT_MAX / 1000) {
+                fprintf(stderr, "Invalid trace time unit '%s' (microseconds)\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--random") == 0) {
+            if (!parse_positive(value, &options.random_count)) {
+                fprintf(stderr, "Invalid process count '%s'\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--seed") == 0) {
+            char* end;
+            errno = 0;
+            unsigned long long seed = strtoull(value, &end, 10);
+            if (*value == '\0' || *end != '\0' || errno != 0) {
+                fprintf(stderr, "Invalid seed '%s'\n", value);
+                return 1;
+            }
+            options.generator.seed = (uint64_t)seed;
+            options.phases.seed = options.generator.seed;
+            options.policy.share.seed = options.generator.seed;
+            bench->seed = options.generator.seed;
+        } else if (strcmp(arg, "--arrivals") == 0) {
+            if (parse_arrivals(value, &options.generator.arrivals) != 0) return 1;
+        } else if (strcmp(arg, "--cpu-burst") == 0) {
+            if (parse_distribution(value, &options.generator.cpu_burst) != 0) return 1;
+        } else if (strcmp(arg, "--io-burst") == 0) {
+            if (parse_distribution(value, &options.generator.io_burst) != 0) return 1;
+        } else if (strcmp(arg, "--io-count") == 0) {
+            int io_count;
+            if (parse_int_list(value, &io_count, 1, 0, MAX_IO_OPERATIONS) != 1) {
+                fprintf(stderr, "Invalid I/O count '%s' (0-%d)\n", value, MAX_IO_OPERATIONS);
+                return 1;
+            }
+            options.generator.io_count = io_count;
+        } else if (strcmp(arg, "--phases") == 0) {
+            if (parse_phases(value, &options.phases) != 0) return 1;
+            options.use_phases = 1;
+        } else if (strcmp(arg, "--save") == 0) {
+            options.save_path = value;
+        } else if (strcmp(arg, "--import") == 0) {
+            import_path = value;
+        } else if (strcmp(arg, "--output") == 0) {
+            output_path = value;
+        } else if (strcmp(arg, "--algorithm") == 0) {
+            if (parse_algorithms(value, algorithms) != 0) return 1;
+        } else if (strcmp(arg, "--preemption") == 0) {
+            if (strcmp(value, "on") == 0) {
+                preemptive = 1;
+                non_preemptive = 0;
+            } else if (strcmp(value, "off") == 0) {
+                preemptive = 0;
+                non_preemptive = 1;
+            } else if (strcmp(value, "both") == 0) {
+                preemptive = non_preemptive = 1;
+            } else {
+                fprintf(stderr, "Invalid preemption mode '%s' (on, off or both)\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--quantum") == 0) {
+            if (!parse_positive(value, &options.policy.time_quantum)) {
+                fprintf(stderr, "Invalid time quantum '%s'\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--mlfq-quanta") == 0) {
+            options.policy.mlfq.num_levels = parse_int_list(value, options.policy.mlfq.quanta, MLFQ_MAX_LEVELS, 1, INT_MAX);
+            if (options.policy.mlfq.num_levels <= 0) {
+                fprintf(stderr, "Invalid MLFQ quanta '%s' (1-%d positive values)\n", value, MLFQ_MAX_LEVELS);
+                return 1;
+            }
+        } else if (strcmp(arg, "--mlfq-boost") == 0) {
+            if (parse_int_list(value, &options.policy.mlfq.boost_period, 1, 0, INT_MAX) != 1) {
+                fprintf(stderr, "Invalid MLFQ boost period '%s'\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--cfs-latency") == 0) {
+            if (!parse_positive(value, &options.policy.cfs.target_latency)) {
+                fprintf(stderr, "Invalid CFS target latency '%s'\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--cfs-granularity") == 0) {
+            if (!parse_positive(value, &options.policy.cfs.min_granularity)) {
+                fprintf(stderr, "Invalid CFS minimum granularity '%s'\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--cpus") == 0) {
+            if (!parse_positive(value, &options.machine.num_cpus) || options.machine.num_cpus > MAX_CPUS) {
+                fprintf(stderr, "Invalid CPU count '%s' (1-%d)\n", value, MAX_CPUS);
+                return 1;
+            }
+        } else if (strcmp(arg, "--migration-cost") == 0) {
+            if (parse_int_list(value, &options.machine.migration_cost, 1, 0, INT_MAX / 4) != 1) {
+                fprintf(stderr, "Invalid migration cost '%s'\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--switch-cost") == 0 || strcmp(arg, "--preempt-cost") == 0) {
+            int* cost = strcmp(arg, "--switch-cost") == 0 ? &options.machine.dispatch_cost
+                                                          : &options.machine.preemption_cost;
+            if (parse_int_list(value, cost, 1, 0, INT_MAX / 8) != 1) {
+                fprintf(stderr, "Invalid value '%s' for %s\n", value, arg);
+                return 1;
+            }
+        } else if (strcmp(arg, "--cache-refill") == 0) {
+            int refill[2];
+            if (parse_int_list(value, refill, 2, 1, INT_MAX / 8) != 2) {
+                fprintf(stderr, "Invalid cache refill '%s' (COST,TIME)\n", value);
+                return 1;
+            }
+            options.machine.refill_cost = refill[0];
+            options.machine.refill_time = refill[1];
+        } else if (strcmp(arg, "--affinity") == 0) {
+            options.affinity_path = value;
+        } else if (strcmp(arg, "--shares") == 0) {
+            options.shares_path = value;
+        } else if (strcmp(arg, "--share-window") == 0) {
+            if (parse_int_list(value, &options.policy.share.window, 1, 0, INT_MAX) != 1) {
+                fprintf(stderr, "Invalid share window '%s'\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--threads") == 0) {
+            if (!parse_positive(value, &options.num_threads)) {
+                fprintf(stderr, "Invalid thread count '%s'\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--cache") == 0) {
+            options.cache_dir = value;
+        } else if (strcmp(arg, "--quantum-sweep") == 0) {
+            if (parse_int_list(value, options.sweep, 2, 1, INT_MAX) != 2 || options.sweep[0] > options.sweep[1]) {
+                fprintf(stderr, "Invalid quantum range '%s' (LOW,HIGH)\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--sweep-metric") == 0) {
+            int m = 0;
+            while (m < NUM_SWEEP_METRICS && strcmp(value, sweep_metric_names[m]) != 0) m++;
+            if (m == NUM_SWEEP_METRICS) {
+                fprintf(stderr, "Invalid sweep metric '%s' (waiting, p99-response or switches)\n", value);
+                return 1;
+            }
+            options.sweep_metric = (enum SweepMetric)m;
+        } else if (strcmp(arg, "--fork-at") == 0) {
+            if (!parse_time(value, 0, &options.fork_at)) {
+                fprintf(stderr, "Invalid checkpoint time '%s'\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--stream") == 0) {
+            if (!parse_time(value, 1, &options.stream.duration)) {
+                fprintf(stderr, "Invalid stream duration '%s'\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--stream-window") == 0) {
+            if (!parse_positive(value, &options.stream.window)) {
+                fprintf(stderr, "Invalid stream window '%s'\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--window-span") == 0) {
+            if (parse_int_list(value, &options.stream.span, 1, 1, 1024) != 1) {
+                fprintf(stderr, "Invalid window span '%s' (1-1024)\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--fork-from") == 0) {
+            if (variant_by_key(value) < 0) {
+                fprintf(stderr, "Unknown algorithm '%s' (fcfs, sjf, sjf-p, priority, priority-p, rr, mlfq, cfs, edf "
+                                "or rm)\n", value);
+                return 1;
+            }
+            options.fork_from = value;
+        } else if (strcmp(arg, "--format") == 0) {
+            if (strcmp(value, "csv") == 0) {
+                options.csv_output = 1;
+            } else if (strcmp(value, "text") != 0) {
+                fprintf(stderr, "Invalid format '%s' (text or csv)\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--trace") == 0) {
+            options.trace_path = value;
+        } else if (strcmp(arg, "--trace-format") == 0) {
+            if (strcmp(value, "binary") == 0) {
+                options.trace_format = TRACE_FORMAT_BINARY;
+            } else if (strcmp(value, "chrome") == 0) {
+                options.trace_format = TRACE_FORMAT_CHROME;
+            } else {
+                fprintf(stderr, "Invalid trace format '%s' (binary or chrome)\n", value);
+                return 1;
+            }
+            trace_format_given = 1;
+        } else if (strcmp(arg, "--trace-convert") == 0) {
+            convert_path = value;
+        } else {
+            fprintf(stderr, "Unknown option '%s'\n", arg);
+            print_usage(argv[0]);
+            return 1;
         }
+        i++;
     }
 
-    if (completed_count > 0) {
-        printf("\n--- Performance Metrics ---\n");
-        printf("Average Waiting Time: %.2f\n", total_waiting_time / completed_count);
-        printf("Average Turnaround Time: %.2f\n", total_turnaround_time / completed_count);
-    } else {
-        printf("\nNo processes were completed to evaluate.\n");
+    if (options.trace_path != NULL && !trace_format_given) {
+        const char* extension = strrchr(options.trace_path, '.');
+        options.trace_format = extension != NULL && strcmp(extension, ".json") == 0 ? TRACE_FORMAT_CHROME
+                                                                                    : TRACE_FORMAT_BINARY;
     }
-}
 
-int simulate_process_tick(Process* p, int current_time) {
-    // 1) CPU 사용량 업데이트
-    p->remaining_cpu_total--;
-    p->cpu_done_current_segment++;
-    p->total_cpu_done++;
+    // Converter: binary trace to Chrome JSON
+    if (convert_path != NULL) {
+        if (output_path == NULL) {
+            fprintf(stderr, "--trace-convert needs --output\n");
+            return 1;
+        }
+        TraceSink* sink = trace_sink_open(output_path, TRACE_FORMAT_CHROME);
+        if (sink == NULL) return 1;
+        int result = trace_replay_binary(convert_path, sink);
+        if (sink->finish(sink) != 0) {
+            fprintf(stderr, "Failed to write trace file %s\n", output_path);
+            result = -1;
+        }
+        return result == 0 ? 0 : 1;
+    }
 
-    // 2. 다음 I/O 요청 시점인지 확인
-    if (p->current_io_index < p->num_io_operations) {
-        IOOperation* next_io = &p->io_operations[p->current_io_index];
-        
-        if (p->total_cpu_done == next_io->request_time) {
-            // I/O 작업 시작
-            p->state = 3;
-            p->io_complete_at_time = current_time + 1 + next_io->burst_time;
-            p->current_io_index++; // 다음 I/O 작업으로 이동
-            
-            heap_insert(&waiting_queue, p);
-            return 1; // I/O로 전환
+    Workload workload = {0};
+
+    // Converter: text workload to binary workload file
+    if (import_path != NULL) {
+        if (output_path == NULL) {
+            fprintf(stderr, "--import needs --output\n");
+            return 1;
+        }
+        if (workload_import_csv(&workload, import_path) != 0) return 1;
+        int result = workload_save_binary(&workload, output_path);
+        if (result == 0) {
+            printf("Imported %d processes (%zu I/O operations) into %s\n",
+                   workload.count, workload.num_io_operations, output_path);
         }
+        workload_free(&workload);
+        return result == 0 ? 0 : 1;
     }
 
-    // 3. 프로세스의 모든 CPU 작업이 완료되었는지 확인
-    if (p->remaining_cpu_total == 0) {
-        p->state = 4;
-        p->completion_time = current_time + 1;
-        return 2; // 완료
+    for (int v = 0; v < NUM_SCHEDULER_VARIANTS; v++) {
+        const SchedulerVariant* variant = &scheduler_variants[v];
+        int preemption_ok = variant->mode == FCFS_MODE || variant->mode == RR_MODE || variant->mode == MLFQ_MODE ||
+                            variant->mode == CFS_MODE || realtime_mode(variant->mode) || share_mode(variant->mode) ||
+                            (variant->preemption_mode == PREEMPTIVE ? preemptive : non_preemptive);
+        options.selected[v] = algorithms[variant->mode] && preemption_ok;
     }
-    
-    return 0; // 계속 실행
-}
 
-void run_scheduler_generic(const char* algo_name, enum SchedulingMode mode, enum PreemptionMode preemption_mode) {
-    reset_processes_for_simulation();
-    current_scheduling_mode = mode;
-    current_preemption_mode = preemption_mode;
-    
-    switch (mode) {
-        case FCFS_MODE:
-            ready_queue.compare = compare_fcfs;
-            break;
-        case SJF_MODE:
-            ready_queue.compare = compare_sjf;
-            break;
-        case PRIORITY_MODE:
-            ready_queue.compare = compare_priority;
-            break;
-        case RR_MODE:
-            ready_queue.compare = compare_rr;
-            break;
+    if (options.cache_dir != NULL && mkdir(options.cache_dir, 0777) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Cannot create result cache %s: %s\n", options.cache_dir, strerror(errno));
+        return 1;
+    }
+    if (options.sweep[0] > 0 && (options.fork_at >= 0 || options.trace_path != NULL || options.verbose)) {
+        fprintf(stderr, "--quantum-sweep does not support --fork-at, --trace or --verbose\n");
+        return 1;
+    }
+    int fork_base = -1;
+    if (options.fork_at >= 0) {
+        if (options.trace_path != NULL || options.verbose) {
+            fprintf(stderr, "--fork-at does not support --trace or --verbose\n");
+            return 1;
+        }
+        for (int v = 0; v < NUM_SCHEDULER_VARIANTS && fork_base < 0; v++) {
+            if (options.selected[v]) fork_base = v;
+        }
+        if (options.fork_from != NULL) fork_base = variant_by_key(options.fork_from);
+    } else if (options.fork_from != NULL) {
+        fprintf(stderr, "--fork-from needs --fork-at\n");
+        return 1;
     }
 
-    printf("\n--- Running");
-    if (preemption_mode == NON_PREEMPTIVE && mode != RR_MODE && mode != FCFS_MODE) {
-        printf(" Non-Preemptive");
-    } else if (preemption_mode == PREEMPTIVE && mode != RR_MODE && mode != FCFS_MODE) {
-        printf(" Preemptive");
+    if (options.bench || options.stream.duration > 0) deselect_unnamed_realtime(options.selected, algorithms);
+    if (options.bench) {
+        bench->num_threads = options.num_threads;
+        return run_benchmark(&options.bench_options, options.selected, &options.policy, &options.machine);
     }
-    printf(" %s Scheduler ------\n", algo_name);
 
-    int current_time = 0;
-    int completed_count = 0;
-    Process* running_process = NULL;
-    int current_process_start_cpu_time = 0;
+    if (options.stream.duration > 0) return run_stream_main(&options);
 
-    while (completed_count < num_processes) {
-        // 1. Add newly arrived processes to ready queue
-        for (int i = 0; i < num_processes; ++i) {
-            if (processes[i].state == 0 && processes[i].arrival_time <= current_time) {
-                processes[i].state = 1;
-                processes[i].last_active_time = current_time;
-                processes[i].queue_entry_time = current_time;
-                heap_insert(&ready_queue, &processes[i]);
-            }
-        }
-
-        // 2. Check for I/O completions using waiting queue
-        while (waiting_queue.size != 0) {
-            Process* p_waiting = waiting_queue.heap[0];
-            if (p_waiting->io_complete_at_time <= current_time) {
-                Process* p = heap_extract_min(&waiting_queue);
-                
-                // Update the actual process and add to ready queue
-                for (int k = 0; k < num_processes; ++k) {
-                    if (processes[k].pid == p->pid) {
-                        processes[k].state = 1;
-                        processes[k].last_active_time = current_time;   //waiting time 계산 위해서 ready queue 입장 시간 기록
-                        processes[k].cpu_done_current_segment = 0;
-                        processes[k].queue_entry_time = current_time;   // RR에서 FIFO 순서를 위해서 queue 입장 시간 기록
-                        heap_insert(&ready_queue, &processes[k]);
-                        break;
-                    }
-                }
-            } else {
-                break;
-            }
+    int sources = (options.workload_path != NULL) + (options.csv_path != NULL) + (options.tasks_path != NULL) +
+                  (options.sched_trace_path != NULL) + (options.random_count > 0);
+    if (sources != 1) {
+        fprintf(stderr, "Choose exactly one of --workload, --csv, --tasks, --sched-trace or --random\n");
+        return 1;
+    }
+    if (options.horizon > 0 && options.tasks_path == NULL) {
+        fprintf(stderr, "--horizon needs --tasks\n");
+        return 1;
+    }
+    int loaded = 0;
+    if (options.workload_path != NULL) {
+        loaded = workload_load_binary(&workload, options.workload_path);
+    } else if (options.csv_path != NULL) {
+        loaded = workload_import_csv(&workload, options.csv_path);
+    } else if (options.tasks_path != NULL) {
+        loaded = workload_load_task_set(&workload, options.tasks_path, options.horizon, options.generator.seed);
+    } else if (options.sched_trace_path != NULL) {
+        loaded = workload_import_sched_trace(&workload, options.sched_trace_path, options.sched_tick);
+    } else {
+        loaded = generate_workload(&workload, options.random_count, &options.generator, options.num_threads);
+        if (loaded == 0) {
+            fprintf(stderr, "Random workload: %d processes, seed %llu\n", options.random_count,
+                    (unsigned long long)options.generator.seed);
         }
+    }
+    if (loaded == 0 && options.affinity_path != NULL) {
+        loaded = workload_load_affinity(&workload, options.affinity_path, options.machine.num_cpus);
+    }
+    if (loaded == 0 && options.shares_path != NULL) loaded = workload_load_shares(&workload, options.shares_path);
+    if (loaded != 0) {
+        workload_free(&workload);
+        return 1;
+    }
+    if (options.save_path != NULL && workload_save_binary(&workload, options.save_path) != 0) {
+        workload_free(&workload);
+        return 1;
+    }
+    if (options.use_phases) workload.phases = &options.phases;
+    if (workload.realtime == NULL) {
+        deselect_unnamed_realtime(options.selected, algorithms);
+    } else {
+        realtime_analysis(&workload, options.machine.num_cpus, options.csv_output ? stderr : stdout);
+    }
 
-        // 3. Preemption logic ONLY for preemptive algorithms
-        if (running_process != NULL && ready_queue.size != 0 && preemption_mode == PREEMPTIVE) {
-            Process* potential_preemptor = ready_queue.heap[0];
-            int should_preempt = 0;
+    if (options.sweep[0] > 0) {
+        int result = run_quantum_sweep(&workload, options.sweep[0], options.sweep[1], options.sweep_metric,
+                                       &options.policy, &options.machine, options.num_threads, options.csv_output,
+                                       options.cache_dir);
+        workload_free(&workload);
+        return result == 0 ? 0 : 1;
+    }
 
-            if (mode == SJF_MODE &&
-                potential_preemptor->remaining_cpu_total < running_process->remaining_cpu_total) {
-                should_preempt = 1;
-            } else if (mode == PRIORITY_MODE &&
-                       potential_preemptor->priority < running_process->priority) {
-                should_preempt = 1;
-            }
+    char trace_names[NUM_SCHEDULER_VARIANTS][PATH_MAX];
+    const char* trace_paths[NUM_SCHEDULER_VARIANTS] = {NULL};
+    if (options.trace_path != NULL) {
+        int num_selected = 0;
+        for (int v = 0; v < NUM_SCHEDULER_VARIANTS; v++) num_selected += options.selected[v];
+        for (int v = 0; v < NUM_SCHEDULER_VARIANTS; v++) {
+            if (!options.selected[v]) continue;
+            trace_path_for_variant(options.trace_path, scheduler_variants[v].key, num_selected > 1,
+                                   trace_names[v], sizeof(trace_names[v]));
+            trace_paths[v] = trace_names[v];
+        }
+    }
+    int trace_status = 0;
 
-            if (should_preempt) {
-                add_gantt_entry(running_process->pid, current_process_start_cpu_time, current_time);    // 기존 process gantt에 기록
-                running_process->state = 1;
-                running_process->last_active_time = current_time;
-                running_process->current_quantum_slice = 0;
-                running_process->queue_entry_time = current_time;
-                heap_insert(&ready_queue, running_process);
-                running_process = NULL;
-            }
+    SimMetrics merged[NUM_SCHEDULER_VARIANTS];
+    int64_t checkpoint = -1;
+    if (fork_base >= 0) {
+        trace_status = run_fork_comparison(&workload, fork_base, options.fork_at, options.selected, &options.policy,
+                                           &options.machine, options.num_threads, merged, &checkpoint);
+    } else if (options.verbose) {
+        // Reports are printed in order, so run one after another
+        SimContext ctx;
+        sim_context_init(&ctx, &workload);
+        ctx.policy = options.policy;
+        ctx.machine = options.machine;
+        memset(merged, 0, sizeof(merged));
+        for (int v = 0; v < NUM_SCHEDULER_VARIANTS; v++) {
+            if (!options.selected[v]) continue;
+            if (run_variant(&ctx, v, trace_paths[v], options.trace_format) != 0) trace_status = -1;
+            metrics_merge(&merged[v], &ctx.metrics);
         }
+        sim_context_free(&ctx);
+    } else {
+        trace_status = run_batch_comparison(&workload, 1, options.selected, &options.policy, &options.machine, options.num_threads, trace_paths, options.trace_format, options.cache_dir, merged);
+    }
 
-        // 4. Dispatch if CPU is idle (using configured ready queue)
-        if (running_process == NULL && ready_queue.size != 0) {
-            Process* next_p = heap_extract_min(&ready_queue);
-            if (next_p) {
-                running_process = next_p;
-                running_process->state = 2;
-                if (!running_process->has_started_execution) {
-                    running_process->start_time = current_time;
-                    running_process->response_time = current_time - running_process->arrival_time;
-                    running_process->has_started_execution = 1;
-                }
-                running_process->waiting_time += current_time - running_process->last_active_time;
-                running_process->current_quantum_slice = 0;
-                current_process_start_cpu_time = current_time;
-            }
-        }
-
-        // 5. Simulate CPU execution for one tick
-        if (running_process != NULL) {
-            int tick_result = simulate_process_tick(running_process, current_time);
-            running_process->current_quantum_slice++;
-
-            if (tick_result == 1) { // Went to I/O (added to waiting queue)
-                add_gantt_entry(running_process->pid, current_process_start_cpu_time, current_time + 1);
-                running_process = NULL;
-            } else if (tick_result == 2) { // Fully completed
-                add_gantt_entry(running_process->pid, current_process_start_cpu_time, current_time + 1);
-                completed_count++;
-                running_process = NULL;
-            } else { // Continues running
-                // RR Preemption
-                if (mode == RR_MODE && running_process->current_quantum_slice >= TIME_QUANTUM) {
-                    add_gantt_entry(running_process->pid, current_process_start_cpu_time, current_time + 1);
-                    running_process->state = 1;
-                    running_process->last_active_time = current_time + 1;
-                    running_process->queue_entry_time = current_time + 1;
-                    heap_insert(&ready_queue, running_process);
-                    running_process = NULL;
-                }
+    if (options.csv_output) {
+        print_batch_results_csv(merged);
+    } else {
+        printf("\n--- Results: %d processes, time quantum %d", workload.count, options.policy.time_quantum);
+        if (options.selected[variant_by_key("mlfq")]) {
+            printf(", MLFQ quanta");
+            for (int level = 0; level < options.policy.mlfq.num_levels; level++) {
+                printf("%s%d", level == 0 ? " " : ",", options.policy.mlfq.quanta[level]);
             }
+            printf(" boost %d", options.policy.mlfq.boost_period);
         }
-
-        current_time++;
-        
-        // 무한 루프 방지
-        if (current_time > 10000 && completed_count < num_processes) {
-            printf("Simulation for %s possibly stuck. Time: %d, Completed: %d/%d\n", 
-                   algo_name, current_time, completed_count, num_processes);
-            break;
+        if (options.selected[variant_by_key("cfs")]) {
+            printf(", CFS latency %d granularity %d", options.policy.cfs.target_latency,
+                   options.policy.cfs.min_granularity);
         }
-        
-        if (completed_count == num_processes && running_process == NULL && 
-            ready_queue.size == 0 && waiting_queue.size == 0) break;
-        
-        if (completed_count < num_processes && running_process == NULL && 
-            ready_queue.size == 0) {
-            // Advance time to next event if CPU idle
-            int next_event_time = INT_MAX;
-            for (int i = 0; i < num_processes; ++i) {
-                if (processes[i].state == 0 && processes[i].arrival_time < next_event_time) {
-                    next_event_time = processes[i].arrival_time;
-                }
-            }
-            
-            if (waiting_queue.size != 0) {
-                Process* next_io = waiting_queue.heap[0];
-                if (next_io->io_complete_at_time < next_event_time) {
-                    next_event_time = next_io->io_complete_at_time;
-                }
-            }
-            
-            if (next_event_time != INT_MAX && next_event_time > current_time) {
-                add_gantt_entry(0, current_time, next_event_time);
-                current_time = next_event_time;
-                continue;
-            } else if (next_event_time == INT_MAX && completed_count < num_processes) {
-                break;
-            }
+        if (options.selected[variant_by_key("lottery")]) {
+            printf(", lottery seed %llu", (unsigned long long)options.policy.share.seed);
+        }
+        if (options.machine.num_cpus > 1) {
+            printf(", %d CPUs, migration cost %d", options.machine.num_cpus, options.machine.migration_cost);
+        }
+        if (options.machine.dispatch_cost > 0 || options.machine.preemption_cost > 0) {
+            printf(", switch cost %d (+%d after preemption)", options.machine.dispatch_cost,
+                   options.machine.preemption_cost);
         }
+        if (options.machine.refill_cost > 0) {
+            printf(", cache refill %d after %d off-CPU", options.machine.refill_cost, options.machine.refill_time);
+        }
+        if (fork_base >= 0 && checkpoint >= 0) {
+            printf(", %s up to t=%lld", scheduler_variants[fork_base].label, (long long)checkpoint);
+        } else if (fork_base >= 0) {
+            printf(", %s finished before t=%lld", scheduler_variants[fork_base].label,
+                   (long long)options.fork_at);
+        }
+        printf(" ---\n");
+        print_batch_results(merged);
+    }
+    if (options.counters_path != NULL && write_counters_json(options.counters_path, merged) != 0) {
+        trace_status = -1;
     }
-    Evaluation(algo_name);
-}
-
-// Specific Schedulers
-void Schedule_FCFS() {
-    run_scheduler_generic("FCFS", FCFS_MODE, NON_PREEMPTIVE);
-}
-
-void Schedule_SJF_NonPreemptive() {
-    run_scheduler_generic("SJF", SJF_MODE, NON_PREEMPTIVE);
-}
-
-void Schedule_SJF_Preemptive() {
-    run_scheduler_generic("SJF", SJF_MODE, PREEMPTIVE);
-}
-
-void Schedule_Priority_NonPreemptive() {
-    run_scheduler_generic("Priority", PRIORITY_MODE, NON_PREEMPTIVE);
-}
 
-void Schedule_Priority_Preemptive() {
-    run_scheduler_generic("Priority", PRIORITY_MODE, PREEMPTIVE);
+    workload_free(&workload);
+    return trace_status == 0 ? 0 : 1;
 }
 
-void Schedule_RR() {
-    run_scheduler_generic("Round Robin", RR_MODE, NON_PREEMPTIVE);
-}
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        return batch_main(argc, argv);
+    }
 
-int main() {
     printf("\nWelcome to the CPU Scheduling Simulator!\n");
 
     int choice;
+    Workload workload = {0};
+    SimContext ctx;
+    sim_context_init(&ctx, &workload);
 
     while (1) {
         display_menu();
@@ -643,50 +7489,67 @@ int main() {
 
         switch (choice) {
             case 1:
-                Create_Process();
-                Config();
+                Create_Process(&workload);
+                Config(&ctx, &workload);
                 break;
             case 2:
-                if (num_processes == 0) {
+                if (workload.count == 0) {
                     printf("Please create processes first (Option 1)\n");
                     break;
                 }
-                Schedule_FCFS();
+                Schedule_FCFS(&ctx);
                 break;
             case 3:
-                if (num_processes == 0) {
+                if (workload.count == 0) {
                     printf("Please create processes first (Option 1)\n");
                     break;
                 }
-                Schedule_SJF_NonPreemptive();
+                Schedule_SJF_NonPreemptive(&ctx);
                 break;
             case 4:
-                if (num_processes == 0) {
+                if (workload.count == 0) {
                     printf("Please create processes first (Option 1)\n");
                     break;
                 }
-                Schedule_SJF_Preemptive();
+                Schedule_SJF_Preemptive(&ctx);
                 break;
             case 5:
-                if (num_processes == 0) {
+                if (workload.count == 0) {
                     printf("Please create processes first (Option 1)\n");
                     break;
                 }
-                Schedule_Priority_NonPreemptive();
+                Schedule_Priority_NonPreemptive(&ctx);
                 break;
             case 6:
-                if (num_processes == 0) {
+                if (workload.count == 0) {
                     printf("Please create processes first (Option 1)\n");
                     break;
                 }
-                Schedule_Priority_Preemptive();
+                Schedule_Priority_Preemptive(&ctx);
                 break;
             case 7:
-                if (num_processes == 0) {
+                if (workload.count == 0) {
+                    printf("Please create processes first (Option 1)\n");
+                    break;
+                }
+                Schedule_RR(&ctx);
+                break;
+            case 8:
+                if (workload.count == 0) {
+                    printf("Please create processes first (Option 1)\n");
+                    break;
+                }
+                Schedule_MLFQ(&ctx);
+                break;
+            case 9:
+                if (workload.count == 0) {
                     printf("Please create processes first (Option 1)\n");
                     break;
                 }
-                Schedule_RR();
+                Schedule_CFS(&ctx);
+                break;
+            case 10:
+                Batch_Comparison(&workload);
                 break;
             case 0:
                 printf("Exit the program. Thank you!\n");